@@ -262,7 +262,7 @@ class K2NativeCompilerArguments : CommonCompilerArguments() {
     @Argument(value="-Xoverride-clang-options", valueDescription = "<arg1,arg2,...>", description = "Explicit list of Clang options")
     var clangOptions: Array<String>? = null
 
-    @Argument(value="-Xallocator", valueDescription = "std | mimalloc", description = "Allocator used in runtime")
+    @Argument(value="-Xallocator", valueDescription = "std | mimalloc | slab", description = "Allocator used in runtime")
     var allocator: String = "std"
 
     @Argument(value = "-Xmetadata-klib", description = "Produce a klib that only contains the declarations metadata")
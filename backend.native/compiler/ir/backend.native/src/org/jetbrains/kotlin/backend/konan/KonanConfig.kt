@@ -117,8 +117,8 @@ class KonanConfig(val project: Project, val configuration: CompilerConfiguration
         add(if (debug) "debug.bc" else "release.bc")
         add(if (memoryModel == MemoryModel.STRICT) "strict.bc" else "relaxed.bc")
         if (shouldCoverLibraries || shouldCoverSources) add("profileRuntime.bc")
-        if (configuration.get(KonanConfigKeys.ALLOCATION_MODE) == "mimalloc") {
-            if (!target.supportsMimallocAllocator()) {
+        when (configuration.get(KonanConfigKeys.ALLOCATION_MODE)) {
+            "mimalloc" -> if (!target.supportsMimallocAllocator()) {
                 configuration.report(CompilerMessageSeverity.STRONG_WARNING,
                         "Mimalloc allocator isn't supported on target ${target.name}. Used standard mode.")
                 add("std_alloc.bc")
@@ -126,8 +126,14 @@ class KonanConfig(val project: Project, val configuration: CompilerConfiguration
                 add("opt_alloc.bc")
                 add("mimalloc.bc")
             }
-        } else {
-            add("std_alloc.bc")
+            "slab" -> if (!target.supportsSlabAllocator()) {
+                configuration.report(CompilerMessageSeverity.STRONG_WARNING,
+                        "Slab allocator isn't supported on target ${target.name}. Used standard mode.")
+                add("std_alloc.bc")
+            } else {
+                add("slab_alloc.bc")
+            }
+            else -> add("std_alloc.bc")
         }
     }.map {
         File(distribution.defaultNatives(target)).child(it).absolutePath
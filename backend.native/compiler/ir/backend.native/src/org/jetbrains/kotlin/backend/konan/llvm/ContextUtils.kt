@@ -497,6 +497,7 @@ internal class Llvm(val context: Context, val llvmModule: LLVMModuleRef) {
     val appendToInitalizersTail = importRtFunction("AppendToInitializersTail")
     val addTLSRecord = importRtFunction("AddTLSRecord")
     val clearTLSRecord = importRtFunction("ClearTLSRecord")
+    val visitGlobalRoot = importRtFunction("VisitGlobalRoot")
     val lookupTLS = importRtFunction("LookupTLS")
     val initRuntimeIfNeeded = importRtFunction("Kotlin_initRuntimeIfNeeded")
     val mutationCheck = importRtFunction("MutationCheck")
@@ -370,6 +370,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
     val INIT_THREAD_LOCAL_GLOBALS = 1
     val DEINIT_THREAD_LOCAL_GLOBALS = 2
     val DEINIT_GLOBALS = 3
+    val VISIT_GLOBALS = 4
 
     private fun createInitBody(): LLVMValueRef {
         val initFunction = LLVMAddFunction(context.llvmModule, "", kInitFuncType)!!
@@ -380,6 +381,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                 val bbLocalInit = basicBlock("local_init", null)
                 val bbLocalDeinit = basicBlock("local_deinit", null)
                 val bbGlobalDeinit = basicBlock("global_deinit", null)
+                val bbGlobalVisit = basicBlock("global_visit", null)
                 val bbDefault = basicBlock("default", null) {
                     unreachable()
                 }
@@ -388,7 +390,8 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                         listOf(Int32(INIT_GLOBALS).llvm                to bbInit,
                                Int32(INIT_THREAD_LOCAL_GLOBALS).llvm   to bbLocalInit,
                                Int32(DEINIT_THREAD_LOCAL_GLOBALS).llvm to bbLocalDeinit,
-                               Int32(DEINIT_GLOBALS).llvm              to bbGlobalDeinit),
+                               Int32(DEINIT_GLOBALS).llvm              to bbGlobalDeinit,
+                               Int32(VISIT_GLOBALS).llvm               to bbGlobalVisit),
                         bbDefault)
 
                 // Globals initalizers may contain accesses to objects, so visit them first.
@@ -459,6 +462,24 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                     }
                     ret(null)
                 }
+
+                // Same roots as cleared above, reported to the runtime for heap inspection.
+                appendingTo(bbGlobalVisit) {
+                    val memory = LLVMGetParam(initFunction, 1)!!
+                    context.llvm.fileInitializers
+                            .forEach { irField ->
+                                if (irField.type.binaryTypeIsReference() && irField.storageKind != FieldStorageKind.THREAD_LOCAL) {
+                                    val address = context.llvmDeclarations.forStaticField(irField).storageAddressAccess.getAddress(
+                                            functionGenerationContext
+                                    )
+                                    call(context.llvm.visitGlobalRoot, listOf(memory, address))
+                                }
+                            }
+                    context.llvm.globalSharedObjects.forEach { address ->
+                        call(context.llvm.visitGlobalRoot, listOf(memory, address))
+                    }
+                    ret(null)
+                }
             }
         }
         return initFunction
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.concurrent_mark
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+import kotlin.native.ref.*
+
+class Node(var next: Node?, val payload: IntArray = IntArray(4))
+
+@Test fun runTest() {
+    if (Platform.memoryModel == MemoryModel.RELAXED) return
+    val oldThreshold = GC.threshold
+    val oldCollectCyclesThreshold = GC.collectCyclesThreshold
+    GC.concurrentMark = true
+    GC.threshold = 64
+    GC.collectCyclesThreshold = 16
+    try {
+        val live = createLoop()
+        val garbage = mutableListOf<WeakReference<Node>>()
+        repeat(1000) {
+            garbage += createLoop().let { WeakReference(it) }
+            // Keep mutating the live cycle, while marker thread may look at it.
+            live.next = Node(live)
+        }
+        // Forced collection waits for the marker thread.
+        GC.collect()
+        GC.collect()
+        garbage.forEach { assertNull(it.get()) }
+        assertNotNull(live.next)
+    } finally {
+        GC.concurrentMark = false
+        GC.threshold = oldThreshold
+        GC.collectCyclesThreshold = oldCollectCyclesThreshold
+    }
+}
+
+private fun createLoop(): Node {
+    val head = Node(null)
+    head.next = Node(Node(head))
+    return head
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.gc_helpers
+
+import kotlin.test.*
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+import kotlin.native.ref.*
+
+class Payload(val value: Int)
+
+class Holder(var payload: Payload?)
+
+@Test fun runTest() {
+    if (Platform.memoryModel == MemoryModel.RELAXED) return
+    assertFailsWith<IllegalArgumentException> { GC.helperThreads = -1 }
+    GC.helperThreads = 4
+    assertEquals(4, GC.helperThreads)
+    try {
+        val live = Array(100000) { Payload(it).freeze() }
+        GC.suspend()
+        val garbage = try {
+            releaseBacklog(live)
+        } finally {
+            GC.resume()
+        }
+        GC.collect()
+        garbage.forEach { assertNull(it.get()) }
+        live.forEachIndexed { index, payload -> assertEquals(index, payload.value) }
+    } finally {
+        GC.helperThreads = 0
+    }
+}
+
+// Leaves a lot of pending decrements of frozen objects, so that helper threads are used.
+private fun releaseBacklog(live: Array<Payload>): List<WeakReference<Payload>> {
+    val holders = Array(live.size) { Holder(live[it]) }
+    val garbage = List(live.size) {
+        val payload = Payload(it).freeze()
+        holders[it].payload = payload
+        WeakReference(payload)
+    }
+    holders.forEach { it.payload = null }
+    return garbage
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.gc_pacing
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+
+class Node(val value: Int, val next: Node?)
+
+@Test fun runTest() {
+    if (Platform.memoryModel == MemoryModel.RELAXED) return
+    assertFailsWith<IllegalArgumentException> { GC.targetOverhead = 0.0 }
+    assertFailsWith<IllegalArgumentException> { GC.targetOverhead = 1.0 }
+    assertFailsWith<IllegalArgumentException> { GC.targetHeapBytes = -1 }
+
+    val threshold = GC.threshold
+    val thresholdAllocations = GC.thresholdAllocations
+    GC.autotune = true
+    GC.targetOverhead = 0.1
+    assertEquals(0.1, GC.targetOverhead)
+    GC.targetHeapBytes = 1
+    try {
+        var live: Node? = null
+        for (i in 0 until 10) {
+            repeat(1000) { live = Node(it, live) }
+            GC.collect()
+        }
+        assertTrue(GC.heapBytes > 0)
+        // Heap target cannot be met, so allocation threshold goes down.
+        assertTrue(GC.thresholdAllocations < thresholdAllocations)
+        assertEquals(999, live!!.value)
+    } finally {
+        GC.targetHeapBytes = 0
+        GC.targetOverhead = 0.3
+        GC.threshold = threshold
+        GC.thresholdAllocations = thresholdAllocations
+    }
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.gc_statistics
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+
+class Node(var next: Node?)
+
+@Test fun runTest() {
+    if (Platform.memoryModel == MemoryModel.RELAXED) return
+    val before = GC.statistics
+    repeat(1000) {
+        val node = Node(null)
+        node.next = Node(node)
+    }
+    GC.collect()
+    val after = GC.statistics
+    assertEquals(before.collections + 1, after.collections)
+    assertTrue(after.cycleCollections > before.cycleCollections)
+    assertTrue(after.bytesAllocated - before.bytesAllocated >= 2000)
+    assertTrue(after.bytesFreed - before.bytesFreed >= 2000)
+    assertEquals(0L, after.toFreeSize)
+    assertEquals(0L, after.finalizerQueueSize)
+    assertEquals(after.collections, after.pauseHistogram.sum())
+    assertTrue(after.maxPauseMicros <= after.totalPauseMicros)
+}
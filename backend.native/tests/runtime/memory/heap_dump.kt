@@ -0,0 +1,62 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.heap_dump
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+import kotlinx.cinterop.*
+import platform.posix.*
+
+class RetainedNode(val payload: ByteArray, val next: RetainedNode?)
+
+class PinnedNode(val payload: ByteArray)
+
+@ThreadLocal
+var retained: RetainedNode? = null
+
+@Test fun runTest() {
+    retained = RetainedNode(ByteArray(1000), RetainedNode(ByteArray(1000), null))
+    val untracked = StableRef.create(RetainedNode(ByteArray(10), null))
+    GC.stablePointerRoots = true
+    // Only reachable from the stable pointers.
+    val pointer = StableRef.create(PinnedNode(ByteArray(10)))
+    val second = StableRef.create(pointer.get())
+    val path = "heap_dump.bin"
+    try {
+        GC.dumpHeap(path)
+        val content = readFile(path)
+        assertEquals("KNHEAP01", content.copyOfRange(0, 8).decodeToString())
+        assertTrue(content.decodeToString().contains("runtime.memory.heap_dump.RetainedNode"))
+        assertTrue(content.decodeToString().contains("runtime.memory.heap_dump.PinnedNode"))
+    } finally {
+        pointer.dispose()
+        second.dispose()
+        untracked.dispose()
+        GC.stablePointerRoots = false
+        remove(path)
+    }
+    assertFailsWith<IllegalArgumentException> {
+        GC.dumpHeap("/nonexistent/directory/heap_dump.bin")
+    }
+}
+
+private fun readFile(path: String): ByteArray {
+    val file = fopen(path, "rb") ?: error("Cannot open $path")
+    try {
+        val result = mutableListOf<Byte>()
+        memScoped {
+            val buffer = allocArray<ByteVar>(4096)
+            while (true) {
+                val read = fread(buffer, 1.convert(), 4096.convert(), file).toInt()
+                if (read <= 0) break
+                for (i in 0 until read) result.add(buffer[i])
+            }
+        }
+        return result.toByteArray()
+    } finally {
+        fclose(file)
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.heap_limits
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+
+class Node(val next: Node?, val value: Int)
+
+@Test fun runTest() {
+    if (Platform.memoryModel == MemoryModel.RELAXED) return
+    assertFailsWith<IllegalArgumentException> { GC.softHeapLimit = -1 }
+    assertFailsWith<IllegalArgumentException> { GC.hardHeapLimit = -1 }
+    GC.hardHeapLimit = 1 shl 30
+    try {
+        assertFailsWith<IllegalArgumentException> { GC.softHeapLimit = (1L shl 30) + 1 }
+    } finally {
+        GC.hardHeapLimit = 0
+    }
+
+    GC.collect()
+    GC.hardHeapLimit = GC.heapBytes + (1 shl 20)
+    try {
+        assertFailsWith<OutOfMemoryError> { ByteArray(2 shl 20) }
+        // Garbage is collected before giving up.
+        repeat(10) { ByteArray(512 shl 10) }
+    } finally {
+        GC.hardHeapLimit = 0
+    }
+
+    GC.collect()
+    GC.hardHeapLimit = GC.heapBytes + (1 shl 20)
+    try {
+        // Object allocation cannot throw, so the error is thrown by the next collection.
+        assertFailsWith<OutOfMemoryError> {
+            var chain: Node? = null
+            repeat(100_000) { chain = Node(chain, it) }
+            GC.collect()
+        }
+        GC.collect()
+    } finally {
+        GC.hardHeapLimit = 0
+    }
+
+    val reports = mutableListOf<Long>()
+    GC.softHeapLimitHandler = { reports.add(it) }
+    GC.softHeapLimit = GC.heapBytes + (64 shl 10)
+    try {
+        // Limits are enforced on array allocation.
+        val live = ArrayList<IntArray>()
+        repeat(10_000) { live.add(IntArray(16) { _ -> it }) }
+        assertTrue(reports.isNotEmpty())
+        assertTrue(reports.all { it > GC.softHeapLimit })
+        // Heap keeps growing, but the handler is only called as it grows by a part of the limit.
+        assertTrue(reports.size < 1_000)
+        assertEquals(9_999, live.last()[15])
+    } finally {
+        GC.softHeapLimit = 0
+        GC.softHeapLimitHandler = null
+    }
+
+    reports.clear()
+    GC.collect()
+    GC.softHeapLimitHandler = { reports.add(it) }
+    GC.softHeapLimit = GC.heapBytes + (64 shl 10)
+    try {
+        // Limits are enforced on object allocation too, the handler is called by the next collection.
+        var chain: Node? = null
+        repeat(10_000) { chain = Node(chain, it) }
+        assertTrue(reports.isEmpty())
+        GC.collect()
+        assertTrue(reports.isNotEmpty())
+        assertTrue(reports.all { it > GC.softHeapLimit })
+        assertEquals(9_999, chain!!.value)
+    } finally {
+        GC.softHeapLimit = 0
+        GC.softHeapLimitHandler = null
+    }
+}
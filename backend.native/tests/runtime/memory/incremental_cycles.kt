@@ -0,0 +1,48 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.incremental_cycles
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+import kotlin.native.ref.*
+
+class Node(var next: Node?)
+
+@Test fun runTest() {
+    if (Platform.memoryModel == MemoryModel.RELAXED) return
+    val oldThreshold = GC.threshold
+    val oldCollectCyclesThreshold = GC.collectCyclesThreshold
+    val oldAutotune = GC.autotune
+    assertFailsWith<IllegalArgumentException> { GC.maxPauseMicros = -1 }
+    GC.maxPauseMicros = 1
+    assertEquals(1L, GC.maxPauseMicros)
+    GC.threshold = 100
+    GC.collectCyclesThreshold = 10
+    GC.autotune = false
+    try {
+        val live = createLoop()
+        val cycleCollections = GC.statistics.cycleCollections
+        val garbage = List(10000) { WeakReference(createLoop()) }
+        // Collections triggered while allocating process the candidates slice by slice.
+        assertTrue(GC.statistics.cycleCollections - cycleCollections > 1)
+        assertTrue(garbage.any { it.get() == null })
+        // Forced collection processes all remaining candidates, regardless of the budget.
+        GC.collect()
+        garbage.forEach { assertNull(it.get()) }
+        assertNotNull(live.next)
+    } finally {
+        GC.maxPauseMicros = 0
+        GC.threshold = oldThreshold
+        GC.collectCyclesThreshold = oldCollectCyclesThreshold
+        GC.autotune = oldAutotune
+    }
+}
+
+private fun createLoop(): Node {
+    val head = Node(null)
+    head.next = Node(head)
+    return head
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.large_arrays
+
+import kotlin.test.*
+import kotlin.native.concurrent.MutableData
+import kotlin.native.internal.GC
+
+@Test fun zeroed() {
+    repeat(10) {
+        val array = ByteArray(4 * 1024 * 1024 + it)
+        assertEquals(0, array[0])
+        assertEquals(0, array[array.size - 1])
+        array.fill(42)
+        assertEquals(42, array[array.size - 1])
+    }
+    GC.collect()
+    val longs = LongArray(1024 * 1024)
+    assertTrue(longs.all { it == 0L })
+}
+
+@Test fun copyOf() {
+    val array = IntArray(1024 * 1024) { it }
+    val copy = array.copyOf(2 * 1024 * 1024)
+    assertEquals(1024 * 1024 - 1, copy[1024 * 1024 - 1])
+    assertEquals(0, copy[1024 * 1024])
+    assertEquals(0, copy[copy.size - 1])
+    assertEquals(1024 * 1024, array.size)
+}
+
+@Test fun mutableData() {
+    val data = MutableData()
+    val chunk = ByteArray(64 * 1024) { it.toByte() }
+    repeat(100) { data.append(chunk) }
+    assertEquals(100 * chunk.size, data.size)
+    for (index in 0 until data.size step 4099) {
+        assertEquals((index % chunk.size).toByte(), data[index])
+    }
+}
+
+@Test fun stringBuilder() {
+    val builder = StringBuilder()
+    repeat(500_000) { builder.append('a' + it % 26) }
+    assertEquals(500_000, builder.length)
+    val string = builder.toString()
+    builder.append("tail")
+    assertEquals(500_000, string.length)
+    assertEquals('a' + 499_999 % 26, string[499_999])
+    assertTrue(builder.endsWith("tail"))
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.nursery
+
+import kotlin.test.*
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+
+data class Box(val value: Int)
+
+class Holder(val boxes: MutableList<Box> = mutableListOf())
+
+// Nursery chunks need aligned allocations, and their pages are only discarded on these targets.
+val pagesDiscarded = Platform.osFamily == OsFamily.LINUX || Platform.osFamily == OsFamily.MACOSX ||
+        Platform.osFamily == OsFamily.IOS || Platform.osFamily == OsFamily.ANDROID
+
+@Test fun runTest() {
+    val strict = Platform.memoryModel == MemoryModel.STRICT
+    GC.collect()
+    val initial = GC.statistics
+
+    // Chunks filled with temporaries only are freed.
+    var sum = 0L
+    repeat(100000) {
+        sum += Box(it).value
+    }
+    GC.collect()
+    assertEquals(99999L * 100000 / 2, sum)
+    val afterTemporaries = GC.statistics
+    if (strict && pagesDiscarded)
+        assertTrue(afterTemporaries.nurseryChunksFreed > initial.nurseryChunksFreed)
+
+    // Survivors are spread over many nursery chunks, filled mostly with temporaries.
+    val survivors = mutableListOf<Box>()
+    repeat(100000) {
+        val temporary = Box(it)
+        if (it % 2000 == 0) survivors += temporary.copy()
+    }
+    GC.collect()
+    survivors.forEachIndexed { index, box -> assertEquals(index * 2000, box.value) }
+    // Pages without survivors are returned, though the chunks stay.
+    if (strict && pagesDiscarded)
+        assertTrue(GC.statistics.nurseryBytesDiscarded > afterTemporaries.nurseryBytesDiscarded)
+
+    // Containers allocated by this thread are released by the worker.
+    val worker = Worker.start()
+    val future = worker.execute(TransferMode.SAFE, {
+        Holder().apply { repeat(1000) { boxes += Box(it) } }
+    }) { holder ->
+        holder.boxes.sumBy { it.value }
+    }
+    assertEquals(999 * 1000 / 2, future.result)
+    worker.requestTermination().result
+    GC.collect()
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.trim_heap
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+
+class Node(val value: Int, val next: Node?)
+
+@Test fun runTest() {
+    assertTrue(GC.autoTrim)
+    GC.autoTrim = false
+    try {
+        assertFalse(GC.autoTrim)
+        var spike: Node? = null
+        repeat(100_000) { spike = Node(it, spike) }
+        assertEquals(99_999, spike!!.value)
+        spike = null
+        // At least 100_000 nodes of 16 bytes each were freed since the peak.
+        if (Platform.memoryModel == MemoryModel.STRICT)
+            assertTrue(GC.trimHeap() >= 1_600_000)
+        else
+            GC.trimHeap()
+        // Memory is still usable after trim.
+        var live: Node? = null
+        repeat(100_000) { live = Node(it, live) }
+        assertEquals(99_999, live!!.value)
+        assertTrue(GC.trimHeap() >= 0)
+    } finally {
+        GC.autoTrim = true
+    }
+}
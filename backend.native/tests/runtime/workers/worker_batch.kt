@@ -0,0 +1,65 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_batch
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+data class Tile(val index: Int, val pixels: IntArray)
+
+@Test fun runTest0() {
+    val worker = Worker.start()
+    val group = worker.executeBatch(TransferMode.SAFE, 1000, { Tile(it, IntArray(16) { it }) }) { tile ->
+        tile.index * tile.pixels.sum()
+    }
+    assertEquals(1000, group.size)
+    assertTrue(group.awaitAll())
+    assertEquals(FutureState.COMPUTED, group.state(999))
+    // A worker executes the batch in order.
+    for (index in 0 until 1000) {
+        assertEquals(index, group.awaitAny())
+    }
+    assertEquals(-1, group.awaitAny(0))
+    for (index in 0 until 1000) {
+        assertEquals(index * 120, group.result(index))
+    }
+    // The group is released once consumed.
+    assertEquals(FutureState.INVALID, group.state(0))
+    worker.requestTermination().result
+    println("OK")
+}
+
+@Test fun runTest1() {
+    val pool = WorkerPool.start(4, errorReporting = false)
+    val group = pool.executeBatch(TransferMode.SAFE, 100, { it }) {
+        if (it % 10 == 0) throw Error("Failed $it")
+        it * it
+    }
+    val seen = BooleanArray(group.size)
+    var ready = group.awaitAny()
+    while (ready != -1) {
+        assertFalse(seen[ready])
+        seen[ready] = true
+        if (ready % 10 == 0) {
+            assertEquals(FutureState.THROWN, group.state(ready))
+            assertFailsWith<IllegalStateException> { group.result(ready) }
+        } else {
+            assertEquals(ready * ready, group.consume(ready) { it })
+            assertFailsWith<IllegalStateException> { group.result(ready) }
+        }
+        ready = group.awaitAny()
+    }
+    assertTrue(seen.all { it })
+    assertFailsWith<IllegalArgumentException> {
+        pool.executeBatch(TransferMode.SAFE, 0, { it }) { it }
+    }
+    pool.requestTermination().result
+    assertFailsWith<IllegalStateException> {
+        pool.executeBatch(TransferMode.SAFE, 1, { it }) { it }
+    }
+    println("OK")
+}
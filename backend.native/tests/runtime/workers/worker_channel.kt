@@ -0,0 +1,102 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_channel
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+
+const val MESSAGES = 1000
+
+data class Message(val index: Int, val values: IntArray)
+
+@Test fun runTest0() {
+    val input = WorkerChannel.create<Message>(16)
+    val output = WorkerChannel.create<Message>(16)
+    val producer = Worker.start()
+    val stage = Worker.start()
+    val produced = producer.execute(TransferMode.SAFE, { input }) { input ->
+        for (index in 0 until MESSAGES) {
+            input.send(TransferMode.SAFE) { Message(index, IntArray(10) { index }) }
+        }
+        input.close()
+    }
+    val processed = stage.execute(TransferMode.SAFE, { input to output }) { (input, output) ->
+        while (true) {
+            val message = input.tryReceive() ?: try {
+                input.receive()
+            } catch (e: IllegalStateException) {
+                break
+            }
+            output.send(TransferMode.SAFE) { Message(message.index, IntArray(1) { message.values.sum() }) }
+        }
+        output.close()
+    }
+    for (index in 0 until MESSAGES) {
+        val message = output.receive()
+        assertEquals(index, message.index)
+        assertEquals(index * 10, message.values[0])
+    }
+    produced.result
+    processed.result
+    assertFailsWith<IllegalStateException> { output.receive() }
+    assertNull(output.tryReceive())
+    producer.requestTermination().result
+    stage.requestTermination().result
+    println("OK")
+}
+
+@Test fun runTest1() {
+    assertFailsWith<IllegalArgumentException> {
+        WorkerChannel.create<Message>(0)
+    }
+    val channel = WorkerChannel.create<Message>(2)
+    assertNull(channel.tryReceive())
+    val freshTransfers = GC.statistics.freshTransfers
+    assertTrue(channel.trySend(TransferMode.SAFE) { Message(0, IntArray(0)) })
+    assertTrue(channel.trySend(TransferMode.SAFE) { Message(1, IntArray(0)) })
+    // Just built messages skip the full reachability check.
+    if (Platform.memoryModel == MemoryModel.STRICT) {
+        assertEquals(freshTransfers + 2, GC.statistics.freshTransfers)
+    }
+    var called = false
+    assertFalse(channel.trySend(TransferMode.SAFE) { called = true; Message(2, IntArray(0)) })
+    assertFalse(called)
+    // Object graph reachable from the outside cannot be sent.
+    val shared = Message(3, IntArray(0))
+    val holder = arrayOf(shared)
+    assertEquals(0, channel.tryReceive()!!.index)
+    if (Platform.memoryModel == MemoryModel.STRICT) {
+        assertFailsWith<IllegalStateException> {
+            channel.send(TransferMode.SAFE) { holder[0] }
+        }
+    }
+    channel.close()
+    channel.close()
+    assertFailsWith<IllegalStateException> {
+        channel.send(TransferMode.SAFE) { Message(4, IntArray(0)) }
+    }
+    assertEquals(1, channel.receive().index)
+    assertFailsWith<IllegalStateException> { channel.receive() }
+    println("OK")
+}
+
+@Test fun runTest2() {
+    val channel = WorkerChannel.create<Message>(1)
+    val worker = Worker.start()
+    val received = worker.execute(TransferMode.SAFE, { channel }) { channel ->
+        channel.receive().index
+    }
+    // Worker blocked on the channel still processes its jobs.
+    val future = worker.execute(TransferMode.SAFE, { 21 }) { it * 2 }
+    assertEquals(42, future.result)
+    channel.send(TransferMode.SAFE) { Message(7, IntArray(0)) }
+    assertEquals(7, received.result)
+    channel.close()
+    worker.requestTermination().result
+    println("OK")
+}
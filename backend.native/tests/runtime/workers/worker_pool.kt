@@ -0,0 +1,133 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_pool
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+import kotlin.system.getTimeMillis
+
+data class Shard(val index: Int, val values: IntArray)
+
+fun fib(n: Int): Int = if (n < 2) n else fib(n - 1) + fib(n - 2)
+
+@Test fun runTest0() {
+    val pool = WorkerPool.start(4)
+    val futures = Array(100) { index ->
+        pool.execute(TransferMode.SAFE, { Shard(index, IntArray(1000) { it + index }) }) { shard ->
+            shard.index to shard.values.sum()
+        }
+    }
+    futures.forEachIndexed { index, future ->
+        val (resultIndex, sum) = future.result
+        assertEquals(index, resultIndex)
+        assertEquals(999 * 1000 / 2 + 1000 * index, sum)
+    }
+    pool.requestTermination().result
+    println("OK")
+}
+
+@SharedImmutable
+val executed = AtomicInt(0)
+
+@Test fun runTest1() {
+    val pool = WorkerPool.start(3)
+    // Jobs submitted from the pool threads, all of them must be executed before the termination.
+    val futures = Array(10) { index ->
+        pool.execute(TransferMode.SAFE, { pool to index }) { (pool, index) ->
+            List(10) {
+                pool.execute(TransferMode.SAFE, { index }) {
+                    executed.increment()
+                    fib(15)
+                }
+            }
+        }
+    }
+    pool.requestTermination(processScheduledJobs = true).result
+    assertEquals(100, executed.value)
+    futures.forEach { future ->
+        future.result.forEach { assertEquals(610, it.result) }
+    }
+    assertFailsWith<IllegalStateException> {
+        pool.execute(TransferMode.SAFE, { 0 }) { it }
+    }
+    assertFailsWith<IllegalStateException> {
+        pool.requestTermination()
+    }
+    println("OK")
+}
+
+@Test fun runTest2() {
+    assertFailsWith<IllegalArgumentException> {
+        WorkerPool.start(0)
+    }
+    val pool = WorkerPool.start(2, errorReporting = false)
+    val future = pool.execute(TransferMode.SAFE, { }) {
+        throw Error("Job failed")
+    }
+    assertFailsWith<IllegalStateException> {
+        future.result
+    }
+    // State captured by the job must be a part of the transferred subgraph.
+    val shared = Shard(0, IntArray(1))
+    val captured = try {
+        pool.execute(TransferMode.SAFE, { 1 }) { it + shared.values.size }
+    } catch (e: IllegalStateException) {
+        null
+    }
+    if (captured != null && Platform.memoryModel == MemoryModel.STRICT)
+        println("Fail")
+    captured?.result
+    pool.requestTermination().result
+    println("OK")
+}
+
+@SharedImmutable
+val jobStarted = AtomicInt(0)
+@SharedImmutable
+val terminationRequested = AtomicInt(0)
+
+@Test fun runTest3() {
+    val pool = WorkerPool.start(2)
+    // The job only submits a new one once termination is requested.
+    val future = pool.execute(TransferMode.SAFE, { pool }) { pool ->
+        jobStarted.value = 1
+        while (terminationRequested.value == 0) {}
+        pool.execute(TransferMode.SAFE, { 21 }) { it * 2 }
+    }
+    while (jobStarted.value == 0) {}
+    val termination = pool.requestTermination()
+    assertFailsWith<IllegalStateException> {
+        pool.execute(TransferMode.SAFE, { 0 }) { it }
+    }
+    terminationRequested.value = 1
+    termination.result
+    assertEquals(42, future.result.result)
+    println("OK")
+}
+
+@SharedImmutable
+val longJobStarted = AtomicInt(0)
+@SharedImmutable
+val longJobReleased = AtomicInt(0)
+
+@Test fun runTest4() {
+    val pool = WorkerPool.start(4)
+    val future = pool.execute(TransferMode.SAFE, { 21 }) {
+        longJobStarted.value = 1
+        while (longJobReleased.value == 0) {}
+        it * 2
+    }
+    while (longJobStarted.value == 0) {}
+    // Give the other threads time to park, so that termination is requested while they are idle.
+    val deadline = getTimeMillis() + 100
+    while (getTimeMillis() < deadline) {}
+    val termination = pool.requestTermination()
+    longJobReleased.value = 1
+    termination.result
+    assertEquals(42, future.result)
+    println("OK")
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_stress
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+const val PRODUCERS = 8
+const val JOBS = 2000
+
+@Test fun runTest() {
+    val consumer = Worker.start()
+    val producers = Array(PRODUCERS) { Worker.start() }
+    // All producers flood the queue of the same worker concurrently.
+    val futures = producers.mapIndexed { index, producer ->
+        producer.execute(TransferMode.SAFE, { consumer to index }) { (consumer, index) ->
+            val results = Array(JOBS) { job ->
+                consumer.execute(TransferMode.SAFE, { index * JOBS + job }) { it * 2 }
+            }
+            var sum = 0L
+            results.forEach { sum += it.result }
+            sum
+        }
+    }
+    val total = futures.map { it.result }.sum()
+    val count = PRODUCERS.toLong() * JOBS
+    assertEquals(count * (count - 1), total)
+
+    // Delayed jobs and immediate termination requests still take their turn.
+    val delayed = AtomicInt(0)
+    consumer.executeAfter(10_000, { delayed.increment() }.freeze())
+    consumer.requestTermination(processScheduledJobs = true).result
+    assertEquals(1, delayed.value)
+    producers.forEach {
+        it.requestTermination(processScheduledJobs = false).result
+    }
+    println("OK")
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_timer
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+const val JOBS = 10000
+
+@SharedImmutable
+val executed = AtomicInt(0)
+
+@SharedImmutable
+val misordered = AtomicInt(0)
+
+@Test fun runTest0() {
+    val worker = Worker.start()
+    // Jobs with the same deadline must not collide.
+    repeat(JOBS) {
+        worker.executeAfter(1000, { executed.increment() }.freeze())
+    }
+    val cancelled = Array(JOBS) {
+        worker.executeAfter(60L * 1000 * 1000, { executed.increment() }.freeze())
+    }
+    cancelled.forEach { assertTrue(it.cancel()) }
+    cancelled.forEach { assertFalse(it.cancel()) }
+    assertFalse(worker.executeAfter(0, {}.freeze()).cancel())
+    // Cancelled jobs are not waited for.
+    worker.requestTermination(processScheduledJobs = true).result
+    assertEquals(JOBS, executed.value)
+    println("OK")
+}
+
+@Test fun runTest1() {
+    val last = AtomicInt(-1)
+    val worker = Worker.start()
+    worker.execute(TransferMode.SAFE, { last }) { last ->
+        val me = Worker.current
+        val jobs = List(100) { index ->
+            me.executeAfter(100L * index) {
+                if (last.value > index) misordered.increment()
+                last.value = index
+            }
+        }
+        // Operations are not frozen, so they are disposed on this worker.
+        jobs.forEachIndexed { index, job ->
+            if (index % 2 == 1) assertTrue(job.cancel())
+        }
+    }.result
+    worker.requestTermination(processScheduledJobs = true).result
+    assertEquals(98, last.value)
+    assertEquals(0, misordered.value)
+    println("OK")
+}
@@ -265,6 +265,9 @@ fun compileSwift(project: Project, target: KonanTarget, sources: List<String>, o
 fun targetSupportsMimallocAllocator(targetName: String) =
         HostManager().targetByName(targetName).supportsMimallocAllocator()
 
+fun targetSupportsSlabAllocator(targetName: String) =
+        HostManager().targetByName(targetName).supportsSlabAllocator()
+
 fun Project.mergeManifestsByTargets(source: File, destination: File) {
     logger.info("Merging manifests: $source -> $destination")
 
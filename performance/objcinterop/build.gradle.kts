@@ -35,6 +35,7 @@ val compileLibary by tasks.creating {
         project.withConvention(ExecClang::class) {
             execKonanClang(HostManager.host) {
                 args("$projectDir/src/nativeInterop/cinterop/complexNumbers.m")
+                args("$projectDir/src/nativeInterop/cinterop/foreignRefs.m")
                 args("-lobjc", "-fobjc-arc")
                 args("-fPIC", "-shared", "-o", "$buildDir/libcomplexnumbers.dylib")
             }
@@ -46,7 +47,8 @@ val native = kotlin.targets.getByName("native") as KotlinNativeTarget
 native.apply {
     compilations["main"].cinterops {
         create("classes") {
-            headers("$projectDir/src/nativeInterop/cinterop/complexNumbers.h")
+            headers("$projectDir/src/nativeInterop/cinterop/complexNumbers.h",
+                    "$projectDir/src/nativeInterop/cinterop/foreignRefs.h")
         }
     }
     binaries.getExecutable(BenchmarkingPlugin.NATIVE_EXECUTABLE_NAME, "RELEASE").linkTask.dependsOn(compileLibary)
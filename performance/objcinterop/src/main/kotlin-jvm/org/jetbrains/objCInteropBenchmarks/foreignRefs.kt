@@ -0,0 +1,17 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+package org.jetbrains.foreignRefs
+
+actual class ForeignRefsBenchmark actual constructor() {
+    actual fun releaseOnThreads1() {
+        error("Benchmark releaseOnThreads1 is unsupported on JVM!")
+    }
+    actual fun releaseOnThreads4() {
+        error("Benchmark releaseOnThreads4 is unsupported on JVM!")
+    }
+    actual fun releaseOnThreads8() {
+        error("Benchmark releaseOnThreads8 is unsupported on JVM!")
+    }
+}
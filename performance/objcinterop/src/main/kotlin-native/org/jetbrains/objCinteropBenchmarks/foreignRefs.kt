@@ -0,0 +1,35 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.foreignRefs
+
+import kotlinx.cinterop.*
+import kotlin.native.internal.GC
+import org.jetbrains.complexNumbers.ForeignRefsReleaser
+import org.jetbrains.complexNumbers.benchmarkSize
+import platform.Foundation.*
+
+class Payload(val value: Int)
+
+actual class ForeignRefsBenchmark actual constructor() {
+    // Kotlin objects passed to Objective-C are released by threads without Kotlin runtime,
+    // so they are enqueued to the owner and processed during the next GC.
+    private fun releaseOnThreads(threads: Int) {
+        val objects = NSMutableArray()
+        autoreleasepool {
+            for (i in 0 until benchmarkSize) {
+                objects.addObject(Payload(i))
+            }
+        }
+        ForeignRefsReleaser.releaseObjects(objects, threads)
+        GC.collect()
+    }
+
+    actual fun releaseOnThreads1() = releaseOnThreads(1)
+
+    actual fun releaseOnThreads4() = releaseOnThreads(4)
+
+    actual fun releaseOnThreads8() = releaseOnThreads(8)
+}
@@ -6,6 +6,7 @@
 
 import org.jetbrains.benchmarksLauncher.*
 import org.jetbrains.complexNumbers.*
+import org.jetbrains.foreignRefs.*
 import kotlinx.cli.*
 
 class ObjCInteropLauncher: Launcher() {
@@ -19,7 +20,10 @@ class ObjCInteropLauncher: Launcher() {
                     "stringToObjC" to BenchmarkEntryWithInit.create(::ComplexNumbersBenchmark, { stringToObjC() }),
                     "stringFromObjC" to BenchmarkEntryWithInit.create(::ComplexNumbersBenchmark, { stringFromObjC() }),
                     "fft" to BenchmarkEntryWithInit.create(::ComplexNumbersBenchmark, { fft() }),
-                    "invertFft" to BenchmarkEntryWithInit.create(::ComplexNumbersBenchmark, { invertFft() })
+                    "invertFft" to BenchmarkEntryWithInit.create(::ComplexNumbersBenchmark, { invertFft() }),
+                    "releaseForeignRefs1" to BenchmarkEntryWithInit.create(::ForeignRefsBenchmark, { releaseOnThreads1() }),
+                    "releaseForeignRefs4" to BenchmarkEntryWithInit.create(::ForeignRefsBenchmark, { releaseOnThreads4() }),
+                    "releaseForeignRefs8" to BenchmarkEntryWithInit.create(::ForeignRefsBenchmark, { releaseOnThreads8() })
             )
     )
 }
@@ -0,0 +1,12 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.foreignRefs
+
+expect class ForeignRefsBenchmark() {
+    fun releaseOnThreads1()
+    fun releaseOnThreads4()
+    fun releaseOnThreads8()
+}
@@ -0,0 +1,6 @@
+#import <Foundation/Foundation.h>
+
+@interface ForeignRefsReleaser : NSObject
+// Releases objects held by the array on the given number of threads without Kotlin runtime.
++ (void)releaseObjects: (NSMutableArray * _Nonnull)objects onThreads: (int)threads;
+@end
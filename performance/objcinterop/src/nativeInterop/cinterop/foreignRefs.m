@@ -0,0 +1,23 @@
+#import "foreignRefs.h"
+
+@implementation ForeignRefsReleaser
++ (void)releaseObjects: (NSMutableArray * _Nonnull)objects onThreads: (int)threads {
+    NSUInteger count = objects.count;
+    NSUInteger chunk = (count + threads - 1) / threads;
+    NSMutableArray *parts = [NSMutableArray arrayWithCapacity: threads];
+    for (NSUInteger start = 0; start < count; start += chunk) {
+        NSRange range = NSMakeRange(start, MIN(chunk, count - start));
+        [parts addObject: [[objects subarrayWithRange: range] mutableCopy]];
+    }
+    // Parts hold the only references now, so objects are released on the dispatch threads.
+    [objects removeAllObjects];
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    for (NSMutableArray *part in parts) {
+        dispatch_group_async(group, queue, ^{
+            [part removeAllObjects];
+        });
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+}
+@end
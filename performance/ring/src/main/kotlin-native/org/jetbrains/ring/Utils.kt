@@ -19,6 +19,7 @@ package org.jetbrains.ring
 import kotlin.native.concurrent.FreezableAtomicReference as KAtomicRef
 import kotlin.native.concurrent.isFrozen
 import kotlin.native.concurrent.freeze
+import kotlin.native.internal.GC
 
 public actual class AtomicRef<T> constructor(@PublishedApi internal val a: KAtomicRef<T>) {
     public actual inline var value: T
@@ -50,4 +51,22 @@ public actual class AtomicRef<T> constructor(@PublishedApi internal val a: KAtom
     override fun toString(): String = value.toString()
 }
 
-public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(KAtomicRef(initial))
\ No newline at end of file
+public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(KAtomicRef(initial))
+
+public actual fun <T> share(value: T): T = value.freeze()
+
+public actual fun collectAfter(helperThreads: Int, block: () -> Unit) {
+    val oldHelperThreads = GC.helperThreads
+    GC.helperThreads = helperThreads
+    try {
+        GC.suspend()
+        try {
+            block()
+        } finally {
+            GC.resume()
+        }
+        GC.collect()
+    } finally {
+        GC.helperThreads = oldHelperThreads
+    }
+}
@@ -27,6 +27,7 @@ class RingLauncher : Launcher() {
                     "AbstractMethod.sortStrings" to BenchmarkEntryWithInit.create(::AbstractMethodBenchmark, { sortStrings() }),
                     "AbstractMethod.sortStringsWithComparator" to BenchmarkEntryWithInit.create(::AbstractMethodBenchmark, { sortStringsWithComparator() }),
                     "AllocationBenchmark.allocateObjects" to BenchmarkEntryWithInit.create(::AllocationBenchmark, { allocateObjects() }),
+                    "AllocationBenchmark.allocateTemporaries" to BenchmarkEntryWithInit.create(::AllocationBenchmark, { allocateTemporaries() }),
                     "ClassArray.copy" to BenchmarkEntryWithInit.create(::ClassArrayBenchmark, { copy() }),
                     "ClassArray.copyManual" to BenchmarkEntryWithInit.create(::ClassArrayBenchmark, { copyManual() }),
                     "ClassArray.filterAndCount" to BenchmarkEntryWithInit.create(::ClassArrayBenchmark, { filterAndCount() }),
@@ -209,7 +210,11 @@ class RingLauncher : Launcher() {
                     "Casts.classCast" to BenchmarkEntryWithInit.create(::CastsBenchmark, { classCast() }),
                     "Casts.interfaceCast" to BenchmarkEntryWithInit.create(::CastsBenchmark, { interfaceCast() }),
                     "LocalObjects.localArray" to BenchmarkEntryWithInit.create(::LocalObjectsBenchmark, { localArray() }),
-                    "LinkedListWithAtomicsBenchmark" to BenchmarkEntryWithInit.create(::LinkedListWithAtomicsBenchmark, { ensureNext() })
+                    "LinkedListWithAtomicsBenchmark" to BenchmarkEntryWithInit.create(::LinkedListWithAtomicsBenchmark, { ensureNext() }),
+                    "GCHelpers.releaseBacklog1" to BenchmarkEntryWithInit.create(::GCHelpersBenchmark, { releaseBacklog1() }),
+                    "GCHelpers.releaseBacklog2" to BenchmarkEntryWithInit.create(::GCHelpersBenchmark, { releaseBacklog2() }),
+                    "GCHelpers.releaseBacklog4" to BenchmarkEntryWithInit.create(::GCHelpersBenchmark, { releaseBacklog4() }),
+                    "GCHelpers.releaseBacklog8" to BenchmarkEntryWithInit.create(::GCHelpersBenchmark, { releaseBacklog8() })
             )
     )
 }
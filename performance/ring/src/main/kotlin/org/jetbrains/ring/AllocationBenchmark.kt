@@ -22,4 +22,16 @@ open class AllocationBenchmark {
         }
     }
 
+    //Benchmark
+    fun allocateTemporaries() {
+        val list = List(10) { it }
+        repeat(BENCHMARK_SIZE) {
+            for (element in list) {
+                val boxed: Any = element + counter
+                val action = { counter += boxed.hashCode() and 1 }
+                action()
+            }
+        }
+    }
+
 }
\ No newline at end of file
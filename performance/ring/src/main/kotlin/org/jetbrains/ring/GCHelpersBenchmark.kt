@@ -0,0 +1,44 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.ring
+
+const val BACKLOG_SIZE = 100 * BENCHMARK_SIZE
+
+open class GCHelpersBenchmark {
+
+    class Payload(val value: Int)
+
+    class Holder {
+        var payload: Payload? = null
+    }
+
+    private val payloads = Array(BACKLOG_SIZE) { share(Payload(it)) }
+    private val holders = Array(BACKLOG_SIZE) { Holder() }
+
+    // Every released reference to a shared object is a pending decrement, processed by the next GC.
+    private fun releaseBacklog(helperThreads: Int) {
+        collectAfter(helperThreads) {
+            for (index in 0 until BACKLOG_SIZE) {
+                holders[index].payload = payloads[index]
+            }
+            for (holder in holders) {
+                holder.payload = null
+            }
+        }
+    }
+
+    //Benchmark
+    fun releaseBacklog1() = releaseBacklog(1)
+
+    //Benchmark
+    fun releaseBacklog2() = releaseBacklog(2)
+
+    //Benchmark
+    fun releaseBacklog4() = releaseBacklog(4)
+
+    //Benchmark
+    fun releaseBacklog8() = releaseBacklog(8)
+}
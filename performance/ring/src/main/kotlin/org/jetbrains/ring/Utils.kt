@@ -41,3 +41,13 @@ expect class AtomicRef<T> {
 }
 
 public expect fun <T> atomic(initial: T): AtomicRef<T>
+
+/**
+ * Makes [value] shareable between threads, where platform requires that.
+ */
+public expect fun <T> share(value: T): T
+
+/**
+ * Runs [block] with garbage collection suspended, then collects garbage using given number of GC helper threads.
+ */
+public expect fun collectAfter(helperThreads: Int, block: () -> Unit)
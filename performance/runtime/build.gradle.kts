@@ -0,0 +1,56 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+import org.jetbrains.kotlin.benchmark.BenchmarkingPlugin
+import org.jetbrains.kotlin.gradle.plugin.mpp.KotlinNativeTarget
+import org.jetbrains.kotlin.gradle.plugin.mpp.NativeBuildType
+import org.jetbrains.kotlin.konan.target.HostManager
+
+plugins {
+    id("benchmarking")
+}
+
+val defaultBuildType = NativeBuildType.RELEASE
+val nativeBuildType = (findProperty("nativeBuildType") as String?)?.let { NativeBuildType.valueOf(it) } ?: defaultBuildType
+
+// Runtime configuration being measured, each one is reported as a separate application.
+val memoryModel = (findProperty("runtimeMemoryModel") as String?) ?: "strict"
+val allocator = (findProperty("runtimeAllocator") as String?) ?: "std"
+
+val runtimeDir = "$projectDir/../../runtime"
+val hostName = HostManager.host.name
+
+benchmark {
+    applicationName = "Runtime${memoryModel.capitalize()}${allocator.capitalize()}"
+    commonSrcDirs = listOf("../../tools/benchmarks/shared/src", "src/main/kotlin", "../shared/src/main/kotlin")
+    jvmSrcDirs = listOf("src/main/kotlin-jvm", "../shared/src/main/kotlin-jvm")
+    nativeSrcDirs = listOf("src/main/kotlin-native", "../shared/src/main/kotlin-native/common")
+    mingwSrcDirs = listOf("src/main/kotlin-native", "../shared/src/main/kotlin-native/mingw")
+    posixSrcDirs = listOf("src/main/kotlin-native", "../shared/src/main/kotlin-native/posix")
+    buildType = nativeBuildType
+
+    dependencies.common(project(":endorsedLibraries:kotlinx.cli"))
+}
+
+val native = kotlin.targets.getByName("native") as KotlinNativeTarget
+native.apply {
+    compilations["main"].cinterops {
+        create("runtimeBenchmarks") {
+            includeDirs("$runtimeDir/src/benchmarks/headers")
+        }
+    }
+    binaries.getExecutable(BenchmarkingPlugin.NATIVE_EXECUTABLE_NAME, nativeBuildType).apply {
+        // Benchmarks are compiled against the runtime sources, as they use its internal API.
+        linkTask.dependsOn(":runtime:${hostName}Benchmarks")
+        // Compiler flags of the binary are set by the plugin after evaluation, so these go after them.
+        afterEvaluate {
+            freeCompilerArgs = freeCompilerArgs + listOf(
+                    "-native-library", "$runtimeDir/build/$hostName/benchmarks.bc",
+                    "-memory-model", memoryModel,
+                    "-Xallocator=$allocator"
+            )
+        }
+    }
+}
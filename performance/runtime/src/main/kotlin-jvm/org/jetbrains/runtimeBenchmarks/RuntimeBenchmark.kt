@@ -0,0 +1,42 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.runtimeBenchmarks
+
+actual class RuntimeBenchmark actual constructor() {
+    actual fun allocInstance() {
+        error("Benchmark allocInstance is unsupported on JVM!")
+    }
+    actual fun allocSmallArray() {
+        error("Benchmark allocSmallArray is unsupported on JVM!")
+    }
+    actual fun allocLargeArray() {
+        error("Benchmark allocLargeArray is unsupported on JVM!")
+    }
+    actual fun updateHeapRef() {
+        error("Benchmark updateHeapRef is unsupported on JVM!")
+    }
+    actual fun enterLeaveFrame() {
+        error("Benchmark enterLeaveFrame is unsupported on JVM!")
+    }
+    actual fun stablePointer() {
+        error("Benchmark stablePointer is unsupported on JVM!")
+    }
+    actual fun buildGraph(shape: GraphShape) {
+        error("Benchmark buildGraph is unsupported on JVM!")
+    }
+    actual fun freezeSubgraph(shape: GraphShape) {
+        error("Benchmark freezeSubgraph is unsupported on JVM!")
+    }
+    actual fun clearSubgraphReferences(shape: GraphShape) {
+        error("Benchmark clearSubgraphReferences is unsupported on JVM!")
+    }
+    actual fun clearFreshSubgraphReferences(shape: GraphShape) {
+        error("Benchmark clearFreshSubgraphReferences is unsupported on JVM!")
+    }
+    actual fun garbageCollect(shape: GraphShape) {
+        error("Benchmark garbageCollect is unsupported on JVM!")
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.runtimeBenchmarks
+
+import org.jetbrains.runtimeBenchmarks.native.*
+
+actual class RuntimeBenchmark actual constructor() {
+    actual fun allocInstance() = Konan_RuntimeBenchmarks_allocInstance(benchmarkSize)
+
+    actual fun allocSmallArray() = Konan_RuntimeBenchmarks_allocArrayInstance(benchmarkSize, smallArraySize)
+
+    actual fun allocLargeArray() = Konan_RuntimeBenchmarks_allocArrayInstance(benchmarkSize / 100, largeArraySize)
+
+    actual fun updateHeapRef() = Konan_RuntimeBenchmarks_updateHeapRef(benchmarkSize)
+
+    actual fun enterLeaveFrame() = Konan_RuntimeBenchmarks_enterLeaveFrame(benchmarkSize)
+
+    actual fun stablePointer() = Konan_RuntimeBenchmarks_stablePointer(benchmarkSize)
+
+    actual fun buildGraph(shape: GraphShape) = Konan_RuntimeBenchmarks_buildGraph(shape.id, graphSize)
+
+    actual fun freezeSubgraph(shape: GraphShape) = Konan_RuntimeBenchmarks_freezeSubgraph(shape.id, graphSize)
+
+    actual fun clearSubgraphReferences(shape: GraphShape) =
+            Konan_RuntimeBenchmarks_clearSubgraphReferences(shape.id, graphSize)
+
+    actual fun clearFreshSubgraphReferences(shape: GraphShape) {
+        // Otherwise the benchmark silently measures the same as clearSubgraphReferences.
+        check(Konan_RuntimeBenchmarks_clearFreshSubgraphReferences(shape.id, graphSize) != 0) {
+            "clearFreshSubgraphReferences.${shape.label} took the checked path"
+        }
+    }
+
+    actual fun garbageCollect(shape: GraphShape) = Konan_RuntimeBenchmarks_garbageCollect(shape.id, graphSize)
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+import org.jetbrains.benchmarksLauncher.*
+import org.jetbrains.runtimeBenchmarks.*
+import kotlinx.cli.*
+
+class RuntimeLauncher : Launcher() {
+    override val benchmarks = BenchmarksCollection(
+            mutableMapOf(
+                    "allocInstance" to BenchmarkEntryWithInit.create(::RuntimeBenchmark, { allocInstance() }),
+                    "allocSmallArray" to BenchmarkEntryWithInit.create(::RuntimeBenchmark, { allocSmallArray() }),
+                    "allocLargeArray" to BenchmarkEntryWithInit.create(::RuntimeBenchmark, { allocLargeArray() }),
+                    "updateHeapRef" to BenchmarkEntryWithInit.create(::RuntimeBenchmark, { updateHeapRef() }),
+                    "enterLeaveFrame" to BenchmarkEntryWithInit.create(::RuntimeBenchmark, { enterLeaveFrame() }),
+                    "stablePointer" to BenchmarkEntryWithInit.create(::RuntimeBenchmark, { stablePointer() })
+            )
+    )
+
+    init {
+        for (shape in GraphShape.values()) {
+            add("buildGraph.${shape.label}", BenchmarkEntryWithInit.create(::RuntimeBenchmark, { buildGraph(shape) }))
+            add("freezeSubgraph.${shape.label}",
+                    BenchmarkEntryWithInit.create(::RuntimeBenchmark, { freezeSubgraph(shape) }))
+            add("clearSubgraphReferences.${shape.label}",
+                    BenchmarkEntryWithInit.create(::RuntimeBenchmark, { clearSubgraphReferences(shape) }))
+            add("clearFreshSubgraphReferences.${shape.label}",
+                    BenchmarkEntryWithInit.create(::RuntimeBenchmark, { clearFreshSubgraphReferences(shape) }))
+            add("garbageCollect.${shape.label}",
+                    BenchmarkEntryWithInit.create(::RuntimeBenchmark, { garbageCollect(shape) }))
+        }
+    }
+}
+
+fun main(args: Array<String>) {
+    val launcher = RuntimeLauncher()
+    BenchmarksRunner.runBenchmarks(args, { arguments: BenchmarkArguments ->
+        if (arguments is BaseBenchmarkArguments) {
+            launcher.launch(arguments.warmup, arguments.repeat, arguments.prefix,
+                    arguments.filter, arguments.filterRegex, arguments.verbose)
+        } else emptyList()
+    }, benchmarksListAction = launcher::benchmarksListAction)
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.runtimeBenchmarks
+
+// Number of operations in a single run of the benchmark.
+const val benchmarkSize = 10000
+// Number of objects in the graphs.
+const val graphSize = 1000
+const val smallArraySize = 16
+// Large enough to be allocated in the large object space.
+const val largeArraySize = 1024 * 1024
+
+// Must match RuntimeBenchmarkGraphShape in runtime/src/benchmarks/headers/RuntimeBenchmarks.h.
+enum class GraphShape(val id: Int, val label: String) {
+    LIST(0, "list"),
+    TREE(1, "tree"),
+    CYCLE(2, "cycle"),
+    WIDE(3, "wide")
+}
+
+expect class RuntimeBenchmark() {
+    fun allocInstance()
+    fun allocSmallArray()
+    fun allocLargeArray()
+    fun updateHeapRef()
+    fun enterLeaveFrame()
+    fun stablePointer()
+    fun buildGraph(shape: GraphShape)
+    fun freezeSubgraph(shape: GraphShape)
+    fun clearSubgraphReferences(shape: GraphShape)
+    fun clearFreshSubgraphReferences(shape: GraphShape)
+    fun garbageCollect(shape: GraphShape)
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "RuntimeBenchmarks.h"
+
+#include "KAssert.h"
+#include "Memory.h"
+#include "Natives.h"
+#include "Types.h"
+
+extern "C" void Kotlin_native_internal_GC_collect(KRef);
+
+namespace {
+
+// Like ObjHolder, but with several slots.
+template <int Count>
+class ObjSlots {
+ public:
+  ObjSlots() {
+    EnterFrame(frame(), 0, sizeof(*this) / sizeof(void*));
+  }
+
+  ~ObjSlots() {
+    LeaveFrame(frame(), 0, sizeof(*this) / sizeof(void*));
+  }
+
+  ObjHeader* obj(int index) { return slots_[index]; }
+
+  ObjHeader** slot(int index) { return &slots_[index]; }
+
+ private:
+  ObjHeader** frame() { return reinterpret_cast<ObjHeader**>(&frame_); }
+
+  FrameOverlay frame_;
+  ObjHeader* slots_[Count] = {};
+};
+
+inline void setElement(ObjHeader* array, KInt index, ObjHeader* value) {
+  UpdateHeapRef(ArrayAddressOfElementAt(array->array(), index), value);
+}
+
+// Nodes are two element arrays, first element refers to the next node or to the left child.
+void buildGraph(ObjHeader** root, int32_t shape, int32_t size) {
+  RuntimeCheck(size > 0, "Graph must not be empty");
+  ObjHolder node;
+  if (shape == RUNTIME_BENCHMARK_GRAPH_WIDE) {
+    AllocArrayInstance(theArrayTypeInfo, size, root);
+    for (int32_t i = 0; i < size; i++) {
+      AllocInstance(theAnyTypeInfo, node.slot());
+      setElement(*root, i, node.obj());
+    }
+    return;
+  }
+  AllocArrayInstance(theArrayTypeInfo, 2, root);
+  // All nodes are reachable from the root, so they stay alive without own slots.
+  KStdVector<ObjHeader*> nodes;
+  nodes.reserve(size);
+  nodes.push_back(*root);
+  for (int32_t i = 1; i < size; i++) {
+    AllocArrayInstance(theArrayTypeInfo, 2, node.slot());
+    switch (shape) {
+      case RUNTIME_BENCHMARK_GRAPH_TREE:
+        setElement(nodes[(i - 1) / 2], (i - 1) % 2, node.obj());
+        break;
+      case RUNTIME_BENCHMARK_GRAPH_CYCLE:
+        setElement(node.obj(), 1, *root);
+        // Fall through.
+      default:
+        setElement(nodes.back(), 0, node.obj());
+        break;
+    }
+    nodes.push_back(node.obj());
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+void Konan_RuntimeBenchmarks_allocInstance(int32_t iterations) {
+  ObjHolder holder;
+  for (int32_t i = 0; i < iterations; i++) {
+    AllocInstance(theAnyTypeInfo, holder.slot());
+  }
+}
+
+void Konan_RuntimeBenchmarks_allocArrayInstance(int32_t iterations, int32_t size) {
+  ObjHolder holder;
+  for (int32_t i = 0; i < iterations; i++) {
+    AllocArrayInstance(theByteArrayTypeInfo, size, holder.slot());
+  }
+}
+
+void Konan_RuntimeBenchmarks_updateHeapRef(int32_t iterations) {
+  ObjSlots<3> slots;
+  AllocArrayInstance(theArrayTypeInfo, 1, slots.slot(0));
+  AllocInstance(theAnyTypeInfo, slots.slot(1));
+  AllocInstance(theAnyTypeInfo, slots.slot(2));
+  for (int32_t i = 0; i < iterations; i++) {
+    setElement(slots.obj(0), 0, slots.obj(1 + (i & 1)));
+  }
+}
+
+void Konan_RuntimeBenchmarks_enterLeaveFrame(int32_t iterations) {
+  for (int32_t i = 0; i < iterations; i++) {
+    ObjSlots<4> slots;
+  }
+}
+
+void Konan_RuntimeBenchmarks_stablePointer(int32_t iterations) {
+  ObjSlots<2> slots;
+  AllocInstance(theAnyTypeInfo, slots.slot(0));
+  for (int32_t i = 0; i < iterations; i++) {
+    void* pointer = CreateStablePointer(slots.obj(0));
+    DerefStablePointer(pointer, slots.slot(1));
+    DisposeStablePointer(pointer);
+  }
+}
+
+void Konan_RuntimeBenchmarks_buildGraph(int32_t shape, int32_t size) {
+  ObjHolder root;
+  buildGraph(root.slot(), shape, size);
+}
+
+void Konan_RuntimeBenchmarks_freezeSubgraph(int32_t shape, int32_t size) {
+  ObjHolder root;
+  buildGraph(root.slot(), shape, size);
+  FreezeSubgraph(root.obj());
+}
+
+void Konan_RuntimeBenchmarks_clearSubgraphReferences(int32_t shape, int32_t size) {
+  ObjHolder root;
+  buildGraph(root.slot(), shape, size);
+  void* pointer = CreateStablePointer(root.obj());
+  bool cleared = ClearSubgraphReferences(root.obj(), true);
+  RuntimeCheck(cleared, "Graph must be detachable");
+  root.clear();
+  AdoptStablePointer(pointer, root.slot());
+}
+
+int32_t Konan_RuntimeBenchmarks_clearFreshSubgraphReferences(int32_t shape, int32_t size) {
+  ObjHolder root;
+  buildGraph(root.slot(), shape, size);
+  void* pointer = CreateStablePointer(root.obj());
+  bool fresh = ClearFreshSubgraphReferences(root.obj());
+  bool cleared = fresh || ClearSubgraphReferences(root.obj(), true);
+  RuntimeCheck(cleared, "Graph must be detachable");
+  root.clear();
+  AdoptStablePointer(pointer, root.slot());
+  return fresh ? 1 : 0;
+}
+
+void Konan_RuntimeBenchmarks_garbageCollect(int32_t shape, int32_t size) {
+  {
+    ObjHolder root;
+    buildGraph(root.slot(), shape, size);
+  }
+  Kotlin_native_internal_GC_collect(nullptr);
+}
+
+}  // extern "C"
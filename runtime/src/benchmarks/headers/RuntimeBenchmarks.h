@@ -0,0 +1,52 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_BENCHMARKS_H
+#define RUNTIME_BENCHMARKS_H
+
+#include <stdint.h>
+
+// Microbenchmarks of the runtime primitives, linked into the benchmark program as a native library,
+// so that they run with the memory model and the allocator the program is compiled with.
+// Timing is done by the caller, every function repeats its operation the given number of times.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shapes of object graphs for the benchmarks working on a whole subgraph.
+enum RuntimeBenchmarkGraphShape {
+  // Each node refers to the next one.
+  RUNTIME_BENCHMARK_GRAPH_LIST = 0,
+  // Balanced binary tree.
+  RUNTIME_BENCHMARK_GRAPH_TREE = 1,
+  // List, where each node also refers to the head, so that all nodes form a single cycle.
+  RUNTIME_BENCHMARK_GRAPH_CYCLE = 2,
+  // Array of leaf objects.
+  RUNTIME_BENCHMARK_GRAPH_WIDE = 3
+};
+
+void Konan_RuntimeBenchmarks_allocInstance(int32_t iterations);
+void Konan_RuntimeBenchmarks_allocArrayInstance(int32_t iterations, int32_t size);
+void Konan_RuntimeBenchmarks_updateHeapRef(int32_t iterations);
+void Konan_RuntimeBenchmarks_enterLeaveFrame(int32_t iterations);
+void Konan_RuntimeBenchmarks_stablePointer(int32_t iterations);
+
+// Builds the graph only, as the baseline for the subgraph benchmarks below.
+void Konan_RuntimeBenchmarks_buildGraph(int32_t shape, int32_t size);
+void Konan_RuntimeBenchmarks_freezeSubgraph(int32_t shape, int32_t size);
+// Passes the graph through the same steps as the transfer of the object to another worker, and adopts it back.
+void Konan_RuntimeBenchmarks_clearSubgraphReferences(int32_t shape, int32_t size);
+// Same, but with the check for fresh subgraphs, as done for the messages of worker channels.
+// Returns 1 if the graph was detached by the fresh subgraph check, 0 if it took the checked path.
+int32_t Konan_RuntimeBenchmarks_clearFreshSubgraphReferences(int32_t shape, int32_t size);
+// Collects the graph which has just become garbage.
+void Konan_RuntimeBenchmarks_garbageCollect(int32_t shape, int32_t size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // RUNTIME_BENCHMARKS_H
@@ -566,6 +566,14 @@ void Kotlin_BooleanArray_copyImpl(KConstRef thiz, KInt fromIndex,
   copyImpl<KBoolean>(thiz, fromIndex, destination, toIndex, count);
 }
 
+KBoolean Kotlin_ByteArray_growInPlace(KRef thiz, KInt newSize) {
+  return TryGrowArrayInPlace(thiz->array(), newSize);
+}
+
+KBoolean Kotlin_CharArray_growInPlace(KRef thiz, KInt newSize) {
+  return TryGrowArrayInPlace(thiz->array(), newSize);
+}
+
 KLong Kotlin_LongArray_get(KConstRef thiz, KInt index) {
   return PrimitiveArrayGet<KLong>(thiz, index);
 }
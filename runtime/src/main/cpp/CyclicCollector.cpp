@@ -19,6 +19,7 @@
 
 #include "Alloc.h"
 #include "Atomic.h"
+#include "GCTrace.h"
 #include "KAssert.h"
 #include "Memory.h"
 #include "MemoryPrivate.hpp"
@@ -176,6 +177,7 @@ class CyclicCollector {
          CHECK_CALL(pthread_cond_wait(&cond_, &lock_), "Cannot wait collector condition")
          if (!shallRunCollector_) continue;
          atomicSet(&gcRunning_, 1);
+         gcTraceBegin("cyclicCollector");
          restartCount = 0;
         restart:
          COLLECTOR_LOG("start cycle GC\n");
@@ -304,6 +306,7 @@ class CyclicCollector {
          }
          if (toRelease_.size() > 0)
            atomicSet(&pendingRelease_, 1);
+         gcTraceEnd("cyclicCollector");
          atomicSet(&gcRunning_, 0);
          shallRunCollector_ = false;
          COLLECTOR_LOG("end cycle GC\n");
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "GCTrace.h"
+
+#include "Alloc.h"
+#include "Atomic.h"
+#include "Common.h"
+#include "Porting.h"
+
+#if KONAN_WASM || KONAN_ZEPHYR
+#define WITH_GC_TRACE 0
+#else
+#define WITH_GC_TRACE 1
+#endif
+
+#if WITH_GC_TRACE
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#if !KONAN_NO_THREADS
+#include <pthread.h>
+#endif
+
+namespace {
+
+// Number of events in the per-thread ring buffer. When overflown during a long phase, oldest events are lost.
+constexpr uint64_t kGCTraceBufferSize = 16 * 1024;
+// Buffer is written out after outermost phase, once that many events are pending.
+constexpr uint64_t kGCTraceFlushThreshold = kGCTraceBufferSize / 2;
+
+struct GCTraceEvent {
+  const char* name;
+  uint64_t timestampMicros;
+  char phase;
+};
+
+struct GCTraceBuffer {
+  int threadId;
+  int depth;
+  // Number of events recorded so far, next event goes to `count % kGCTraceBufferSize`.
+  uint64_t count;
+  // Number of events written out.
+  uint64_t flushed;
+  GCTraceEvent events[kGCTraceBufferSize];
+};
+
+enum {
+  kGCTraceUnknown = 0,
+  kGCTraceDisabled,
+  kGCTraceEnabled
+};
+
+volatile int traceState = kGCTraceUnknown;
+const char* tracePath = nullptr;
+volatile int lastThreadId = 0;
+// Output file, opened on the first flush. Guarded by traceLock.
+FILE* traceFile = nullptr;
+bool traceFileEmpty = true;
+#if !KONAN_NO_THREADS
+pthread_mutex_t traceLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+THREAD_LOCAL_VARIABLE GCTraceBuffer* traceBuffer = nullptr;
+
+class TraceLocker {
+ public:
+  TraceLocker() {
+#if !KONAN_NO_THREADS
+    pthread_mutex_lock(&traceLock);
+#endif
+  }
+
+  ~TraceLocker() {
+#if !KONAN_NO_THREADS
+    pthread_mutex_unlock(&traceLock);
+#endif
+  }
+};
+
+bool traceEnabled() {
+  auto state = atomicGet(&traceState);
+  if (state == kGCTraceUnknown) {
+    // Racy initialization is fine, as all threads observe the same environment.
+    tracePath = getenv("KONAN_GC_TRACE");
+    state = tracePath != nullptr && tracePath[0] != '\0' ? kGCTraceEnabled : kGCTraceDisabled;
+    atomicSet(&traceState, state);
+  }
+  return state == kGCTraceEnabled;
+}
+
+void writeEvent(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+void writeEvent(const char* format, ...) {
+  fputs(traceFileEmpty ? "[\n" : ",\n", traceFile);
+  traceFileEmpty = false;
+  va_list args;
+  va_start(args, format);
+  vfprintf(traceFile, format, args);
+  va_end(args);
+}
+
+void flushBuffer(GCTraceBuffer* buffer) {
+  if (buffer->flushed == buffer->count) return;
+  TraceLocker locker;
+  if (traceFile == nullptr && atomicGet(&traceState) == kGCTraceEnabled) {
+    traceFile = fopen(tracePath, "w");
+    if (traceFile == nullptr) {
+      konan::consoleErrorf("Cannot open GC trace file %s\n", tracePath);
+      atomicSet(&traceState, static_cast<int>(kGCTraceDisabled));
+    }
+  }
+  if (traceFile == nullptr) {
+    buffer->flushed = buffer->count;
+    return;
+  }
+  int pid = getpid();
+  if (buffer->flushed == 0) {
+    writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"Kotlin GC %d\"}}",
+        pid, buffer->threadId, buffer->threadId);
+  }
+  uint64_t first = buffer->count - buffer->flushed > kGCTraceBufferSize
+      ? buffer->count - kGCTraceBufferSize : buffer->flushed;
+  for (uint64_t index = first; index < buffer->count; index++) {
+    const auto& event = buffer->events[index % kGCTraceBufferSize];
+    writeEvent("{\"name\":\"%s\",\"cat\":\"gc\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":%d,\"tid\":%d}",
+        event.name, event.phase, static_cast<unsigned long long>(event.timestampMicros), pid, buffer->threadId);
+  }
+  // Trailing "]" is optional in the trace event format, so the file is valid after every flush.
+  fflush(traceFile);
+  buffer->flushed = buffer->count;
+}
+
+void destroyBuffer(void* argument) {
+  auto* buffer = reinterpret_cast<GCTraceBuffer*>(argument);
+  flushBuffer(buffer);
+  traceBuffer = nullptr;
+  konanFreeMemory(buffer);
+}
+
+GCTraceBuffer* currentBuffer() {
+  auto* buffer = traceBuffer;
+  if (buffer != nullptr || !traceEnabled()) return buffer;
+  buffer = konanConstructInstance<GCTraceBuffer>();
+  buffer->threadId = atomicAdd(&lastThreadId, 1);
+  traceBuffer = buffer;
+  konan::onThreadExit(destroyBuffer, buffer);
+  return buffer;
+}
+
+void record(GCTraceBuffer* buffer, const char* name, char phase) {
+  auto& event = buffer->events[buffer->count % kGCTraceBufferSize];
+  event.name = name;
+  event.timestampMicros = konan::getTimeMicros();
+  event.phase = phase;
+  buffer->count++;
+}
+
+}  // namespace
+
+void gcTraceBegin(const char* name) {
+  auto* buffer = currentBuffer();
+  if (buffer == nullptr) return;
+  buffer->depth++;
+  record(buffer, name, 'B');
+}
+
+void gcTraceEnd(const char* name) {
+  auto* buffer = traceBuffer;
+  if (buffer == nullptr) return;
+  record(buffer, name, 'E');
+  if (--buffer->depth == 0 && buffer->count - buffer->flushed >= kGCTraceFlushThreshold)
+    flushBuffer(buffer);
+}
+
+void gcTraceFlush() {
+  auto* buffer = traceBuffer;
+  if (buffer != nullptr) flushBuffer(buffer);
+}
+
+#else  // !WITH_GC_TRACE
+
+void gcTraceBegin(const char* name) {}
+
+void gcTraceEnd(const char* name) {}
+
+void gcTraceFlush() {}
+
+#endif  // !WITH_GC_TRACE
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_GC_TRACE_H
+#define RUNTIME_GC_TRACE_H
+
+// Tracing of GC phases in Chrome trace event format (viewable in chrome://tracing and Perfetto).
+// Enabled by setting KONAN_GC_TRACE environment variable to the output file path. Events are recorded
+// to per-thread ring buffers and appended to the file after outermost phases and on thread exit.
+
+// Records the beginning of the GC phase. `name` must be a string literal.
+void gcTraceBegin(const char* name);
+// Records the end of the GC phase.
+void gcTraceEnd(const char* name);
+// Writes out all pending events of the current thread.
+void gcTraceFlush();
+
+class GCTraceScope {
+ public:
+  explicit GCTraceScope(const char* name) : name_(name) { gcTraceBegin(name); }
+  ~GCTraceScope() { gcTraceEnd(name_); }
+
+ private:
+  const char* name_;
+};
+
+#endif  // RUNTIME_GC_TRACE_H
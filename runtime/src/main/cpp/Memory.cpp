@@ -17,7 +17,9 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <cstddef> // for offsetof
+#include <limits>
 
 // Allow concurrent global cycle collector.
 #define USE_CYCLIC_GC 0
@@ -29,6 +31,7 @@
 #include "CyclicCollector.h"
 #endif  // USE_CYCLIC_GC
 #include "Exceptions.h"
+#include "GCTrace.h"
 #include "KString.h"
 #include "Memory.h"
 #include "MemoryPrivate.hpp"
@@ -37,6 +40,13 @@
 #include "Runtime.h"
 #include "WorkerBoundReference.h"
 
+extern "C" {
+
+// Calls GC.softHeapLimitHandler of the current worker.
+void Kotlin_native_internal_GC_notifySoftHeapLimit(KLong heapBytes);
+
+}  // extern "C"
+
 // If garbage collection algorithm for cyclic garbage to be used.
 // We are using the Bacon's algorithm for GC, see
 // http://researcher.watson.ibm.com/researcher/files/us-bacon/Bacon03Pure.pdf.
@@ -49,9 +59,25 @@
 #define COLLECT_STATISTIC 0
 // Define to 1 to print detailed time statistics for GC events.
 #define PROFILE_GC 0
+// Allow running mark phase of the cycle collector on a helper thread.
+#if USE_GC && !KONAN_NO_THREADS
+#define USE_CONCURRENT_MARK 1
+#else
+#define USE_CONCURRENT_MARK 0
+#endif
+// Allocate small containers in per-thread bump pointer chunks.
+#define USE_NURSERY USE_GC
+// Allow using helper threads for reference counter updates of shareable containers during GC.
+#define USE_GC_HELPERS USE_CONCURRENT_MARK
+// Allocate big containers in their own memory mappings.
+#if KONAN_WINDOWS || KONAN_WASM || KONAN_ZEPHYR
+#define USE_LARGE_OBJECT_SPACE 0
+#else
+#define USE_LARGE_OBJECT_SPACE 1
+#endif
 
-#if COLLECT_STATISTIC
-#include <algorithm>
+#if USE_CONCURRENT_MARK || USE_GC_HELPERS
+#include <pthread.h>
 #endif
 
 namespace {
@@ -83,11 +109,22 @@ static_assert(sizeof(ContainerHeader) % kObjectAlignment == 0, "sizeof(Container
 // release candidates set).
 constexpr size_t kGcThreshold = 8 * 1024;
 // Ergonomic thresholds.
-// If GC to computations time ratio is above that value,
-// increase GC threshold by 1.5 times.
-constexpr double kGcToComputeRatioThreshold = 0.5;
+// Default target fraction of the program time spent in GC.
+constexpr double kDefaultGcTargetOverhead = 0.3;
+// Thresholds are only adjusted if smoothed GC overhead differs from the target more than that many times.
+constexpr double kGcPacingTolerance = 1.25;
+// Thresholds are changed no more than that many times per collection.
+constexpr double kGcPacingMaxStep = 2.0;
+// Weight of the last collection in the smoothed GC overhead.
+constexpr double kGcPacingSmoothing = 0.5;
+// Lower bound of the estimated survival rate, so that heap target is approached with caution.
+constexpr double kGcPacingMinSurvivalRate = 0.05;
+// While the heap stays above the soft limit, next forced collection happens after it grows by the limit divided by this.
+constexpr uint64_t kSoftHeapLimitStepDivisor = 8;
 // Never exceed this value when increasing GC threshold.
 constexpr size_t kMaxErgonomicThreshold = 32 * 1024;
+// Never go below this value when decreasing GC threshold to keep the heap target.
+constexpr size_t kMinErgonomicThreshold = 1024;
 // Threshold of size for toFree set, triggering actual cycle collector.
 constexpr size_t kMaxToFreeSizeThreshold = 8 * 1024;
 // Never exceed this value when increasing size for toFree set, triggering actual cycle collector.
@@ -96,14 +133,62 @@ constexpr size_t kMaxErgonomicToFreeSizeThreshold = 8 * 1024 * 1024;
 constexpr size_t kFinalizerQueueThreshold = 32;
 // If allocated that much memory since last GC - force new GC.
 constexpr size_t kMaxGcAllocThreshold = 8 * 1024 * 1024;
+// Never exceed this value when increasing allocation threshold.
+constexpr size_t kMaxErgonomicAllocThreshold = 64 * 1024 * 1024;
+// Never go below this value when decreasing allocation threshold to keep the heap target.
+constexpr size_t kMinErgonomicAllocThreshold = 1024 * 1024;
 // If the ratio of GC collection cycles time to program execution time is greater this value,
 // increase GC threshold for cycles collection.
 constexpr double kGcCollectCyclesLoadRatio = 0.3;
 // Minimum time of cycles collection to change thresholds.
 constexpr size_t kGcCollectCyclesMinimumDuration = 200;
+// Heap is trimmed automatically after collection, if it has shrunk to this fraction of its peak since the last trim,
+constexpr double kAutoTrimHeapFraction = 0.5;
+// by at least that many bytes,
+constexpr int64_t kAutoTrimMinBytes = 4 * 1024 * 1024;
+// and the last trim was at least that long ago.
+constexpr uint64_t kAutoTrimIntervalMicros = 1000 * 1000;
+// How many containers trial deletion visits at once, when cycle collection is limited by the pause time.
+constexpr size_t kGcCollectCyclesSliceObjects = 4096;
+// Freed containers up to this size are kept in the per-thread free lists for reuse. Includes the nursery ones,
+// so that free space of the nursery chunks kept alive by survivors is reused before new chunks are allocated.
+constexpr container_size_t kContainerCacheMaxSize = 256;
+// Number of container free lists, one per kObjectAlignment step of the size.
+constexpr size_t kContainerCacheClasses = kContainerCacheMaxSize / kObjectAlignment + 1;
+// How many bytes every container free list may keep.
+constexpr size_t kContainerCacheClassBytes = 16 * 1024;
+
+#if USE_NURSERY
+// Size of the nursery chunk, where small containers are allocated by bumping the pointer.
+// Chunks are aligned to their size, so that chunk of the container is found by its address.
+constexpr size_t kNurseryChunkSize = 64 * 1024;
+static_assert((kNurseryChunkSize & (kNurseryChunkSize - 1)) == 0, "Nursery chunk size must be a power of two");
+// Containers up to this size are allocated in the nursery.
+constexpr container_size_t kNurseryMaxContainerSize = 256;
+// Added to the live counter of the chunk while it is used for allocation, exceeds possible number of containers.
+constexpr int32_t kNurseryOwnerBias = 1 << 30;
+// Retired chunks return their pages to the OS once no live container is left in them, so that survivors
+// only keep the pages they are in. Big enough to be a multiple of the OS page size on common targets.
+constexpr size_t kNurseryPageSize = 16 * 1024;
+constexpr size_t kNurseryChunkPages = kNurseryChunkSize / kNurseryPageSize;
+#endif  // USE_NURSERY
+
+#if USE_GC_HELPERS
+// Maximal number of GC helper threads per worker.
+constexpr int kMaxGcHelpers = 64;
+// Minimal number of reference counter updates worth splitting between helper threads.
+constexpr size_t kGcHelpersMinimumWork = 16 * 1024;
+#endif  // USE_GC_HELPERS
 
 #endif  // USE_GC
 
+#if USE_LARGE_OBJECT_SPACE
+// Containers of this size and bigger get their own memory mapping, see allocLargeContainer().
+constexpr size_t kLargeContainerSize = 256 * 1024;
+// Mappings are rounded up to this size, so that slack at the end could be used to grow the container.
+constexpr size_t kLargeContainerPageSize = 4096;
+#endif  // USE_LARGE_OBJECT_SPACE
+
 typedef KStdUnorderedSet<ContainerHeader*> ContainerHeaderSet;
 typedef KStdVector<ContainerHeader*> ContainerHeaderList;
 typedef KStdDeque<ContainerHeader*> ContainerHeaderDeque;
@@ -115,6 +200,214 @@ typedef KStdDeque<KRef> KRefDeque;
 typedef KStdDeque<KRefList> KRefListDeque;
 typedef KStdUnorderedMap<void**, std::pair<KRef*,int>> KThreadLocalStorageMap;
 
+void* allocOwnedMemory(MemoryState* state, size_t size);
+
+#if USE_GC
+// Number of elements in a single segment of the candidates buffer, so that segment with its links is 8K on 64-bit.
+constexpr size_t kContainerHeaderSegmentSize = 1024 - 2;
+// How many unused segments are kept by the per-thread pool.
+constexpr size_t kMaxPooledContainerHeaderSegments = 64;
+
+struct ContainerHeaderSegment {
+  ContainerHeaderSegment* next;
+  ContainerHeaderSegment* previous;
+  ContainerHeader* data[kContainerHeaderSegmentSize];
+};
+
+// Per-thread pool of unused segments, shared by all the candidates buffers of the memory state.
+class ContainerHeaderSegmentPool {
+ public:
+  explicit ContainerHeaderSegmentPool(MemoryState* owner) : owner_(owner) {}
+
+  ~ContainerHeaderSegmentPool() {
+    while (free_ != nullptr) {
+      auto* next = free_->next;
+      konanFreeMemory(free_);
+      free_ = next;
+    }
+  }
+
+  ContainerHeaderSegment* allocate() {
+    if (free_ == nullptr)
+      return reinterpret_cast<ContainerHeaderSegment*>(allocOwnedMemory(owner_, sizeof(ContainerHeaderSegment)));
+    auto* segment = free_;
+    free_ = segment->next;
+    freeCount_--;
+    return segment;
+  }
+
+  void release(ContainerHeaderSegment* segment) {
+    if (freeCount_ >= kMaxPooledContainerHeaderSegments) {
+      konanFreeMemory(segment);
+      return;
+    }
+    segment->next = free_;
+    free_ = segment;
+    freeCount_++;
+  }
+
+ private:
+  MemoryState* owner_;
+  ContainerHeaderSegment* free_ = nullptr;
+  size_t freeCount_ = 0;
+};
+
+/**
+ * Buffer of GC candidates, made of fixed-size segments taken from the pool. Unlike vector, append never
+ * moves already buffered elements, and iterators pointing to elements stay valid on append. All segments but the last one are full,
+ * and the last one is never empty.
+ */
+class ContainerHeaderBuffer {
+ public:
+  class iterator {
+   public:
+    iterator(ContainerHeaderSegment* segment, size_t index) : segment_(segment), index_(index) {}
+
+    ContainerHeader*& operator*() const { return segment_->data[index_]; }
+
+    iterator& operator++() {
+      if (++index_ == kContainerHeaderSegmentSize && segment_->next != nullptr) {
+        segment_ = segment_->next;
+        index_ = 0;
+      }
+      return *this;
+    }
+
+    bool operator==(const iterator& other) const {
+      return segment_ == other.segment_ && index_ == other.index_;
+    }
+
+    bool operator!=(const iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class ContainerHeaderBuffer;
+
+    ContainerHeaderSegment* segment_;
+    size_t index_;
+  };
+
+  explicit ContainerHeaderBuffer(ContainerHeaderSegmentPool* pool) : pool_(pool) {}
+
+  ~ContainerHeaderBuffer() {
+    clear();
+  }
+
+  size_t size() const {
+    return segmentCount_ == 0 ? 0 : (segmentCount_ - 1) * kContainerHeaderSegmentSize + tailSize_;
+  }
+
+  iterator begin() const { return iterator(head_, 0); }
+  iterator end() const { return iterator(tail_, tailSize_); }
+
+  void push_back(ContainerHeader* container) {
+    if (tail_ == nullptr || tailSize_ == kContainerHeaderSegmentSize) {
+      appendSegment();
+    }
+    tail_->data[tailSize_++] = container;
+  }
+
+  ContainerHeader* back() const {
+    RuntimeAssert(tailSize_ > 0, "Buffer must not be empty");
+    return tail_->data[tailSize_ - 1];
+  }
+
+  void pop_back() {
+    RuntimeAssert(tailSize_ > 0, "Buffer must not be empty");
+    if (--tailSize_ == 0) removeTailSegment();
+  }
+
+  // Drops all elements starting with `position`.
+  void truncate(iterator position) {
+    if (position.segment_ == nullptr) return;
+    while (tail_ != position.segment_) removeTailSegment();
+    tailSize_ = position.index_;
+    if (tailSize_ == 0) removeTailSegment();
+  }
+
+  void clear() {
+    truncate(begin());
+  }
+
+  // Compaction: drops all elements matching `predicate` in a single pass, keeping the order of the rest.
+  template <typename Predicate>
+  void removeIf(Predicate predicate) {
+    auto position = begin();
+    for (auto it = begin(); it != end(); ++it) {
+      auto* container = *it;
+      if (!predicate(container)) {
+        *position = container;
+        ++position;
+      }
+    }
+    truncate(position);
+  }
+
+  void swap(ContainerHeaderBuffer& other) {
+    RuntimeAssert(pool_ == other.pool_, "Buffers must share the pool");
+    std::swap(head_, other.head_);
+    std::swap(tail_, other.tail_);
+    std::swap(tailSize_, other.tailSize_);
+    std::swap(segmentCount_, other.segmentCount_);
+  }
+
+ private:
+  ContainerHeaderSegmentPool* pool_;
+  ContainerHeaderSegment* head_ = nullptr;
+  ContainerHeaderSegment* tail_ = nullptr;
+  size_t tailSize_ = 0;
+  size_t segmentCount_ = 0;
+
+  void appendSegment() {
+    auto* segment = pool_->allocate();
+    segment->next = nullptr;
+    segment->previous = tail_;
+    if (tail_ != nullptr)
+      tail_->next = segment;
+    else
+      head_ = segment;
+    tail_ = segment;
+    tailSize_ = 0;
+    segmentCount_++;
+  }
+
+  void removeTailSegment() {
+    auto* segment = tail_;
+    tail_ = segment->previous;
+    if (tail_ != nullptr)
+      tail_->next = nullptr;
+    else
+      head_ = nullptr;
+    tailSize_ = tail_ != nullptr ? kContainerHeaderSegmentSize : 0;
+    segmentCount_--;
+    pool_->release(segment);
+  }
+
+  ContainerHeaderBuffer(const ContainerHeaderBuffer&) = delete;
+  ContainerHeaderBuffer& operator=(const ContainerHeaderBuffer&) = delete;
+};
+#endif  // USE_GC
+
+#if USE_GC
+// Freed containers of the same size class, see allocContainer().
+struct ContainerFreeList {
+  ContainerHeader* head;
+  uint32_t count;
+  // Minimal count since the last trim, that many containers were not needed for allocations.
+  uint32_t lowWater;
+};
+#endif  // USE_GC
+
+#if USE_NURSERY
+struct NurseryChunk {
+  // Number of live containers in the chunk, see allocNurseryContainer().
+  volatile int32_t liveCount;
+  // Number of live containers in every page, containers crossing the page boundary are counted in both pages.
+  // The first page holds this header, so it is never returned.
+  volatile int32_t pageLiveCount[kNurseryChunkPages];
+  // Then we have sequence of the containers.
+};
+#endif  // USE_NURSERY
+
 // A little hack that allows to enable -O2 optimizations
 // Prevents clang from replacing FrameOverlay struct
 // with single pointer.
@@ -123,6 +416,10 @@ FrameOverlay exportFrameOverlay;
 
 // Current number of allocated containers.
 volatile int allocCount = 0;
+#if USE_NURSERY
+// Set once the allocator returned misaligned nursery chunk, then nursery is not used at all.
+volatile int nurseryUnsupported = 0;
+#endif  // USE_NURSERY
 volatile int aliveMemoryStatesCount = 0;
 
 KBoolean g_hasCyclicCollector = true;
@@ -314,8 +611,25 @@ inline bool isShareable(ContainerHeader* container) {
     return container == nullptr || container->shareable();
 }
 
+#if USE_CONCURRENT_MARK
+class ConcurrentMarker;
+#endif  // USE_CONCURRENT_MARK
+#if USE_GC
+class HeapDumper;
+#endif  // USE_GC
+#if USE_GC_HELPERS
+class GcHelperPool;
+#endif  // USE_GC_HELPERS
+
 }  // namespace
 
+// Number of objects in a block of the foreign references release queue.
+constexpr int32_t kReleaseQueueBlockSize = 254;
+// Number of free blocks kept by the consumer of the queue for reuse.
+constexpr int32_t kReleaseQueueMaxFreeBlocks = 4;
+// Number of busy waiting iterations before the consumer starts giving up its time slice to a slow producer.
+constexpr int32_t kReleaseQueueSpins = 64;
+
 class ForeignRefManager {
  public:
   static ForeignRefManager* create() {
@@ -324,6 +638,11 @@ class ForeignRefManager {
     return result;
   }
 
+  ~ForeignRefManager() {
+    freeBlocks(releaseQueue);
+    freeBlocks(freeBlocks_);
+  }
+
   void addRef() {
     atomicAdd(&refCount, 1);
   }
@@ -342,7 +661,7 @@ class ForeignRefManager {
 
   bool tryReleaseRefOwned() {
     if (atomicAdd(&this->refCount, -1) == 0) {
-      if (this->releaseList != nullptr) {
+      if (this->hasEnqueuedReleaseRefs()) {
         // There are no more holders of [this] to process the enqueued work items in [releaseRef].
         // Revert the reference counter back and notify the caller to process and then retry:
         atomicAdd(&this->refCount, 1);
@@ -355,47 +674,127 @@ class ForeignRefManager {
     return true;
   }
 
+  // Can be called by any thread. Only allocates if the owner has not processed the queue for a while.
   void enqueueReleaseRef(ObjHeader* obj) {
-    ListNode* newListNode = konanConstructInstance<ListNode>();
-    newListNode->obj = obj;
+    // Blocks seen by the producer must not be freed until it is done.
+    atomicAdd(&this->activeProducers_, 1);
+    Block* head = atomicGet(&this->releaseQueue);
+    if (head != nullptr) {
+      int32_t index = atomicAdd(&head->reserved, 1) - 1;
+      if (index < kReleaseQueueBlockSize) {
+        head->objects[index] = obj;
+        atomicAdd(&head->committed, 1);
+        atomicAdd(&this->activeProducers_, -1);
+        return;
+      }
+    }
+    // Head block is full, or already taken by the owner: push a new one.
+    Block* block = konanConstructInstance<Block>();
+    block->objects[0] = obj;
+    block->reserved = 1;
+    block->committed = 1;
     while (true) {
-      ListNode* next = this->releaseList;
-      newListNode->next = next;
-      if (compareAndSet(&this->releaseList, next, newListNode)) break;
+      block->next = head;
+      if (compareAndSet(&this->releaseQueue, head, block)) break;
+      head = atomicGet(&this->releaseQueue);
     }
+    atomicAdd(&this->activeProducers_, -1);
   }
 
+  // Must only be called by the owner, or by the last holder of the manager.
   template <typename func>
   void processEnqueuedReleaseRefsWith(func process) {
-    if (releaseList == nullptr) return;
-
-    ListNode* toProcess = nullptr;
-
+    if (!hasEnqueuedReleaseRefs()) return;
+
+    // Replace the queue with an empty block, so that producers normally do not allocate.
+    Block* empty = freeBlocks_;
+    if (empty != nullptr) {
+      freeBlocks_ = empty->next;
+      freeBlocksCount_--;
+      empty->next = nullptr;
+      atomicSet(&empty->committed, 0);
+      atomicSet(&empty->reserved, 0);
+    }
+    Block* toProcess = nullptr;
     while (true) {
-      toProcess = releaseList;
-      if (compareAndSet<ListNode*>(&this->releaseList, toProcess, nullptr)) break;
+      toProcess = atomicGet(&this->releaseQueue);
+      if (compareAndSet(&this->releaseQueue, toProcess, empty)) break;
     }
 
     while (toProcess != nullptr) {
-      process(toProcess->obj);
-      ListNode* next = toProcess->next;
-      konanDestructInstance(toProcess);
+      // Producers could still hold a reference to the block, so close it for them
+      // and wait for the ones which reserved a slot already.
+      int32_t reserved = atomicAdd(&toProcess->reserved, kClosedBlock) - kClosedBlock;
+      int32_t count = reserved < kReleaseQueueBlockSize ? reserved : kReleaseQueueBlockSize;
+      for (int32_t spins = 0; atomicGet(&toProcess->committed) != count; spins++) {
+        if (spins < kReleaseQueueSpins)
+          konan::spinPause();
+        else
+          konan::yieldThread();
+      }
+      for (int32_t index = 0; index < count; index++)
+        process(toProcess->objects[index]);
+      Block* next = toProcess->next;
+      toProcess->next = freeBlocks_;
+      freeBlocks_ = toProcess;
+      freeBlocksCount_++;
       toProcess = next;
     }
+    trimFreeBlocks();
   }
 
 private:
+  // Added to the reserved count of the block taken from the queue, so that late producers go for a new block.
+  static constexpr int32_t kClosedBlock = 1 << 30;
+
+  // Multiple-producers single-consumer queue of objects released by foreign threads is a stack of blocks.
+  // Producers reserve slots in the head block with an atomic increment. Blocks are recycled by the consumer
+  // only, and a late producer reserving a slot in a recycled block is harmless: its slot is either rejected
+  // as the block is still closed, or is a valid slot of a block being reused, as counters are reset before
+  // the block is published again.
+  struct Block {
+    Block* next;
+    volatile int32_t reserved;
+    volatile int32_t committed;
+    ObjHeader* objects[kReleaseQueueBlockSize];
+  };
+
   int refCount;
 
-  struct ListNode {
-    ObjHeader* obj;
-    ListNode* next;
-  };
+  Block* volatile releaseQueue;
+  // Number of producers which could still access blocks taken out of the queue.
+  volatile int32_t activeProducers_;
+  // Free blocks, only accessed by the consumer.
+  Block* freeBlocks_;
+  int32_t freeBlocksCount_;
+
+  // Free blocks are out of the queue, so once there are no active producers, no one else could access them.
+  // Otherwise the surplus is kept until the next time.
+  void trimFreeBlocks() {
+    if (freeBlocksCount_ <= kReleaseQueueMaxFreeBlocks || atomicGet(&this->activeProducers_) != 0) return;
+    while (freeBlocksCount_ > kReleaseQueueMaxFreeBlocks) {
+      Block* block = freeBlocks_;
+      freeBlocks_ = block->next;
+      freeBlocksCount_--;
+      konanFreeMemory(block);
+    }
+  }
 
-  ListNode* volatile releaseList;
+  bool hasEnqueuedReleaseRefs() {
+    Block* head = atomicGet(&this->releaseQueue);
+    return head != nullptr && (head->next != nullptr || atomicGet(&head->reserved) > 0);
+  }
+
+  static void freeBlocks(Block* block) {
+    while (block != nullptr) {
+      Block* next = block->next;
+      konanFreeMemory(block);
+      block = next;
+    }
+  }
 
   void processAbandoned() {
-    if (this->releaseList != nullptr) {
+    if (this->hasEnqueuedReleaseRefs()) {
       bool hadNoStateInitialized = (memoryState == nullptr);
 
       if (hadNoStateInitialized) {
@@ -403,7 +802,7 @@ private:
         if (atomicGet(&aliveMemoryStatesCount) == 0)
           return;
 
-        memoryState = InitMemory(); // Required by ReleaseHeapRef.
+        memoryState = InitMemory(false); // Required by ReleaseHeapRef.
       }
 
       processEnqueuedReleaseRefsWith([](ObjHeader* obj) {
@@ -418,6 +817,53 @@ private:
   }
 };
 
+// Layout of the statistics snapshot, must match kotlin.native.internal.GCStatistics.
+enum GcStatisticsIndex {
+  kGcStatCollections = 0,
+  kGcStatCycleCollections,
+  kGcStatTotalPauseMicros,
+  kGcStatMaxPauseMicros,
+  kGcStatBytesAllocated,
+  kGcStatBytesFreed,
+  kGcStatToFreeSize,
+  kGcStatToReleaseSize,
+  kGcStatFinalizerQueueSize,
+  kGcStatFreshTransfers,
+  kGcStatNurseryChunksFreed,
+  kGcStatNurseryBytesDiscarded,
+  // Pauses shorter than 100us, 1ms, 10ms, 100ms and longer ones.
+  kGcStatPauseHistogram,
+  kGcStatPauseHistogramBuckets = 5,
+  kGcStatCount = kGcStatPauseHistogram + kGcStatPauseHistogramBuckets
+};
+
+// Always collected per-worker GC counters, cheap enough to be updated on every allocation.
+struct GcStatistics {
+  uint64_t collections;
+  uint64_t cycleCollections;
+  uint64_t totalPauseMicros;
+  uint64_t maxPauseMicros;
+  uint64_t pauseHistogram[kGcStatPauseHistogramBuckets];
+  // Containers could be freed by other workers, so freed bytes could exceed allocated ones.
+  uint64_t bytesAllocated;
+  uint64_t bytesFreed;
+  // Subgraphs detached by clearFreshSubgraphReferences().
+  uint64_t freshTransfers;
+  // Nursery chunks freed and nursery pages returned to the OS by this worker.
+  uint64_t nurseryChunksFreed;
+  uint64_t nurseryBytesDiscarded;
+
+  void recordPause(uint64_t pauseMicros) {
+    collections++;
+    totalPauseMicros += pauseMicros;
+    if (pauseMicros > maxPauseMicros) maxPauseMicros = pauseMicros;
+    int bucket = 0;
+    for (uint64_t bound = 100; bucket < kGcStatPauseHistogramBuckets - 1 && pauseMicros >= bound; bound *= 10)
+      bucket++;
+    pauseHistogram[bucket]++;
+  }
+};
+
 struct MemoryState {
 #if TRACE_MEMORY
   // Set of all containers.
@@ -441,18 +887,24 @@ struct MemoryState {
    * and thus requiring only one list, but the downside is that both of the
    * next phases would iterate over the whole list of objects instead of only 10%.
    */
-  ContainerHeaderList* toFree; // List of all cycle candidates.
-  ContainerHeaderList* roots; // Real candidates excluding those with refcount = 0.
+  ContainerHeaderBuffer* toFree; // List of all cycle candidates.
+  ContainerHeaderBuffer* roots; // Real candidates excluding those with refcount = 0.
   // How many GC suspend requests happened.
   int gcSuspendCount;
   // How many candidate elements in toRelease shall trigger collection.
   size_t gcThreshold;
   // How many candidate elements in toFree shall trigger cycle collection.
   uint64_t gcCollectCyclesThreshold;
+  // Upper bound of the GC pause in microseconds cycle collection tries to keep, 0 if unlimited.
+  uint64_t gcMaxPauseMicros;
+  // If cycle collection ran out of its pause budget and shall continue during the next GC.
+  bool gcCollectCyclesPending;
   // If collection is in progress.
   bool gcInProgress;
   // Objects to be released.
-  ContainerHeaderList* toRelease;
+  ContainerHeaderBuffer* toRelease;
+  // Unused segments of the candidates buffers.
+  ContainerHeaderSegmentPool* segmentPool;
 
   ForeignRefManager* foreignRefManager;
 
@@ -463,11 +915,78 @@ struct MemoryState {
 
   uint64_t allocSinceLastGc;
   uint64_t allocSinceLastGcThreshold;
+
+  // Target fraction of the program time spent in GC, thresholds are tuned towards.
+  double gcTargetOverhead;
+  // Target size of the heap allocated by this worker in bytes, 0 if not limited.
+  uint64_t gcTargetHeapBytes;
+  // Limits of the heap allocated by this worker in bytes, 0 if not limited, see checkHeapLimits().
+  uint64_t softHeapLimit;
+  uint64_t hardHeapLimit;
+  // Heap size, exceeding which forces the next soft limit collection.
+  uint64_t softHeapLimitTrigger;
+  // If soft limit handler is running, so that its own allocations do not call it again.
+  bool softHeapLimitNotifying;
+  // If OutOfMemoryError is being thrown, so that it can be allocated regardless of the limits.
+  bool heapLimitsSuspended;
+  // Limits crossed by an object allocation, which cannot throw: heap size to call the soft limit handler with,
+  // or 0, and if OutOfMemoryError is due. Raised by the next allocation that can throw, see raisePendingHeapLimits().
+  int64_t pendingSoftHeapLimitBytes;
+  bool pendingOutOfMemory;
+  // If memory freed by this worker shall be returned to the OS after collections, see maybeTrimHeap().
+  bool gcAutoTrim;
+  // Peak estimated heap size since the last trim, the time of the last trim, and by how much it shrank the heap.
+  int64_t peakHeapBytes;
+  uint64_t lastTrimTimestamp;
+  int64_t lastTrimBytes;
+  // Smoothed fraction of the program time spent in GC.
+  double gcOverhead;
+  // GC counters, allocated bytes minus freed bytes estimate the heap size.
+  GcStatistics gcStatistics;
+  // Heap dump in progress, receives global roots.
+  HeapDumper* heapDumper;
+  // Estimated heap size after the previous collection.
+  int64_t lastHeapBytes;
+  // Freed containers kept for reuse, indexed by the aligned size divided by kObjectAlignment.
+  ContainerFreeList containerCache[kContainerCacheClasses];
+
+#if USE_CONCURRENT_MARK
+  // If mark phase of the cycle collector shall run concurrently with the mutator.
+  bool gcConcurrentMark;
+  // If concurrent mark is in flight, containers cannot be released and are deferred instead.
+  bool concurrentMarkInFlight;
+  // Helper thread performing the concurrent mark, created lazily.
+  ConcurrentMarker* concurrentMarker;
+  // Containers released while concurrent mark was in flight.
+  ContainerHeaderBuffer* deferredFree;
+#endif  // USE_CONCURRENT_MARK
+
+#if USE_NURSERY
+  // Nursery chunk small containers are allocated from, and its free space.
+  NurseryChunk* nurseryChunk;
+  uint8_t* nurseryTop;
+  uint8_t* nurseryEnd;
+  // How many containers were allocated from the current nursery chunk, in total and per page.
+  int32_t nurseryAllocated;
+  int32_t nurseryPageAllocated[kNurseryChunkPages];
+#endif  // USE_NURSERY
+
+#if USE_GC_HELPERS
+  // How many helper threads update reference counters of shareable containers during GC, 0 if none.
+  int gcHelperCount;
+  // Helper threads, created lazily.
+  GcHelperPool* gcHelperPool;
+  // Shareable containers collected for reference counter update by helper threads.
+  ContainerHeaderList* gcHelperWork;
+#endif  // USE_GC_HELPERS
 #endif // USE_GC
 
   // A stack of initializing singletons.
   KStdVector<std::pair<ObjHeader**, ObjHeader*>> initializingSingletons;
 
+  // Allocator heap for the memory only used by this thread, see allocOwnedMemory().
+  void* heap;
+
 #if COLLECT_STATISTIC
   #define CONTAINER_ALLOC_STAT(state, size, container) state->statistic.incAlloc(size, container);
   #define CONTAINER_DESTROY_STAT(state, container) \
@@ -503,6 +1022,20 @@ struct MemoryState {
 
 namespace {
 
+// Allocates zeroed memory, which only this thread allocates and frees unless it's transferred or shared.
+// Memory comes from the heap of the state when called by its thread, and from the shared heap otherwise.
+void* allocOwnedMemory(MemoryState* state, size_t size) {
+  if (state != nullptr && state->heap != nullptr && state == ::memoryState)
+    return konan::callocInHeap(state->heap, 1, size);
+  return konanAllocMemory(size);
+}
+
+void* allocOwnedAlignedMemory(MemoryState* state, size_t size, size_t alignment) {
+  if (state != nullptr && state->heap != nullptr && state == ::memoryState)
+    return konan::callocInHeapAligned(state->heap, 1, size, alignment);
+  return konan::calloc_aligned(1, size, alignment);
+}
+
 #if TRACE_MEMORY
 #define INIT_TRACE(state) \
   memoryState->containers = konanConstructInstance<ContainerHeaderSet>();
@@ -560,7 +1093,12 @@ void freeContainer(ContainerHeader* header) NO_INLINE;
 void garbageCollect(MemoryState* state, bool force) NO_INLINE;
 void cyclicGarbageCollect() NO_INLINE;
 void rememberNewContainer(ContainerHeader* container);
+void rememberFreshContainer(ContainerHeader* container);
+void forgetStablePointers(MemoryState* state);
 #endif  // USE_GC
+#if USE_CONCURRENT_MARK
+void abortConcurrentMark(MemoryState* state);
+#endif  // USE_CONCURRENT_MARK
 
 // Class representing arbitrary placement container.
 class Container {
@@ -802,50 +1340,284 @@ inline bool isFreezableAtomic(ContainerHeader* container) {
   return isFreezableAtomic(obj);
 }
 
-ContainerHeader* allocContainer(MemoryState* state, size_t size) {
- ContainerHeader* result = nullptr;
-#if USE_GC
-  // We recycle elements of finalizer queue for new allocations, to avoid trashing memory manager.
-  ContainerHeader* container = state != nullptr ? state->finalizerQueue : nullptr;
-  ContainerHeader* previous = nullptr;
-  while (container != nullptr) {
-    // TODO: shall it be == instead?
-    if (container->hasContainerSize() &&
-        container->containerSize() >= size && container->containerSize() <= size + 16) {
-      MEMORY_LOG("recycle %p for request %d\n", container, size)
-      result = container;
-      if (previous == nullptr)
-        state->finalizerQueue = container->nextLink();
+#if USE_NURSERY
+inline NurseryChunk* nurseryChunkOf(ContainerHeader* container) {
+  return reinterpret_cast<NurseryChunk*>(reinterpret_cast<uintptr_t>(container) & ~(kNurseryChunkSize - 1));
+}
+
+inline size_t nurseryPageOf(NurseryChunk* chunk, void* address) {
+  return (reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(chunk)) / kNurseryPageSize;
+}
+
+void freeNurseryChunk(MemoryState* state, NurseryChunk* chunk) {
+  konanFreeMemory(chunk);
+  state->gcStatistics.nurseryChunksFreed++;
+}
+
+// Must be called before the container is released from the chunk, so that the chunk is not freed meanwhile.
+void releaseNurseryPage(MemoryState* state, NurseryChunk* chunk, size_t page) {
+  if (page == 0) return;
+  if (konan::discardMemory(reinterpret_cast<uint8_t*>(chunk) + page * kNurseryPageSize, kNurseryPageSize))
+    state->gcStatistics.nurseryBytesDiscarded += kNurseryPageSize;
+}
+
+// Owner no longer allocates from the chunk, so it is freed once all its containers are released.
+void retireNurseryChunk(MemoryState* state) {
+  auto* chunk = state->nurseryChunk;
+  if (chunk == nullptr) return;
+  state->nurseryChunk = nullptr;
+  state->nurseryTop = nullptr;
+  state->nurseryEnd = nullptr;
+  for (size_t page = 0; page < kNurseryChunkPages; page++) {
+    if (atomicAdd(&chunk->pageLiveCount[page], state->nurseryPageAllocated[page] - kNurseryOwnerBias) == 0)
+      releaseNurseryPage(state, chunk, page);
+  }
+  if (atomicAdd(&chunk->liveCount, state->nurseryAllocated - kNurseryOwnerBias) == 0)
+    freeNurseryChunk(state, chunk);
+}
+
+void releaseNurseryContainer(MemoryState* state, ContainerHeader* container) {
+  auto* chunk = nurseryChunkOf(container);
+  size_t first = nurseryPageOf(chunk, container);
+  size_t last = nurseryPageOf(chunk, reinterpret_cast<uint8_t*>(container) +
+      alignUp(container->containerSize(), kObjectAlignment) - 1);
+  for (size_t page = first; page <= last; page++) {
+    if (atomicAdd(&chunk->pageLiveCount[page], -1) == 0)
+      releaseNurseryPage(state, chunk, page);
+  }
+  if (atomicAdd(&chunk->liveCount, -1) == 0)
+    freeNurseryChunk(state, chunk);
+}
+
+/**
+ * Most of small containers are short-lived temporaries, so we allocate them by bumping the pointer
+ * in the per-thread chunk, and free the chunk as a whole once all its containers are released,
+ * instead of calling allocator for every container. Containers are never moved, so survivors
+ * keep their chunk alive, but pages of the chunk without survivors are returned to the OS,
+ * and the space of dead containers is reused through the container cache.
+ * Container could be released by any thread (after transfer or freeze), so live counters of the chunk
+ * are atomic, but the owner adds its allocations in bulk when the chunk is retired: until then counters
+ * are biased by kNurseryOwnerBias and cannot drop to zero.
+ */
+ContainerHeader* allocNurseryContainer(MemoryState* state, container_size_t size) {
+  size_t entrySize = alignUp(size, kObjectAlignment);
+  if (static_cast<size_t>(state->nurseryEnd - state->nurseryTop) < entrySize) {
+    retireNurseryChunk(state);
+    if (atomicGet(&nurseryUnsupported)) return nullptr;
+    auto* chunk = reinterpret_cast<NurseryChunk*>(
+        allocOwnedAlignedMemory(state, kNurseryChunkSize, kNurseryChunkSize));
+    if (chunk == nullptr) return nullptr;
+    if ((reinterpret_cast<uintptr_t>(chunk) & (kNurseryChunkSize - 1)) != 0) {
+      // Alignment is not supported by the allocator, e.g. std alloc on Windows.
+      konanFreeMemory(chunk);
+      atomicSet(&nurseryUnsupported, 1);
+      return nullptr;
+    }
+    chunk->liveCount = kNurseryOwnerBias;
+    for (size_t page = 0; page < kNurseryChunkPages; page++) {
+      chunk->pageLiveCount[page] = kNurseryOwnerBias;
+      state->nurseryPageAllocated[page] = 0;
+    }
+    state->nurseryChunk = chunk;
+    state->nurseryAllocated = 0;
+    state->nurseryTop = reinterpret_cast<uint8_t*>(chunk) + alignUp(sizeof(NurseryChunk), kObjectAlignment);
+    state->nurseryEnd = reinterpret_cast<uint8_t*>(chunk) + kNurseryChunkSize;
+  }
+  // Chunk memory is zero initialized and never reused within the chunk.
+  auto* result = reinterpret_cast<ContainerHeader*>(state->nurseryTop);
+  size_t first = nurseryPageOf(state->nurseryChunk, result);
+  size_t last = nurseryPageOf(state->nurseryChunk, state->nurseryTop + entrySize - 1);
+  state->nurseryPageAllocated[first]++;
+  if (last != first) state->nurseryPageAllocated[last]++;
+  state->nurseryTop += entrySize;
+  state->nurseryAllocated++;
+  result->setNursery();
+  state->allocSinceLastGc += size;
+  atomicAdd(&allocCount, 1);
+  CONTAINER_ALLOC_EVENT(state, size, result);
+#if TRACE_MEMORY
+  state->containers->insert(result);
+#endif
+  return result;
+}
+#endif  // USE_NURSERY
+
+#if USE_GC
+inline size_t containerCacheClass(size_t size) {
+  return alignUp(size, kObjectAlignment) / kObjectAlignment;
+}
+
+inline ContainerHeader* popCachedContainer(MemoryState* state, size_t size) {
+  if (size > kContainerCacheMaxSize) return nullptr;
+  auto& list = state->containerCache[containerCacheClass(size)];
+  auto* result = list.head;
+  if (result == nullptr) return nullptr;
+  list.head = result->nextLink();
+  if (--list.count < list.lowWater)
+    list.lowWater = list.count;
+#if USE_NURSERY
+  bool nursery = result->nursery();
+#endif  // USE_NURSERY
+  // Fresh containers are zero initialized, so the recycled ones must be too.
+  memset(result, 0, alignUp(size, kObjectAlignment));
+#if USE_NURSERY
+  // Still counted as live in its chunk.
+  if (nursery) result->setNursery();
+#endif  // USE_NURSERY
+  return result;
+}
+
+inline bool hasCachedContainer(MemoryState* state, size_t size) {
+  return size <= kContainerCacheMaxSize && state->containerCache[containerCacheClass(size)].head != nullptr;
+}
+
+// Returns false if the container shall be released to the allocator.
+inline bool pushCachedContainer(MemoryState* state, ContainerHeader* container) {
+  if (!container->hasContainerSize()) return false;
+  size_t size = container->containerSize();
+  // Size is not recorded in the aggregating frozen containers.
+  if (size <= sizeof(ContainerHeader) || size > kContainerCacheMaxSize) return false;
+  size_t sizeClass = containerCacheClass(size);
+  auto& list = state->containerCache[sizeClass];
+  if (list.count >= kContainerCacheClassBytes / (sizeClass * kObjectAlignment)) return false;
+  container->setNextLink(list.head);
+  list.head = container;
+  list.count++;
+  return true;
+}
+
+// Releases containers which were not reused since the previous trim, or all of them.
+void trimContainerCache(MemoryState* state, bool all) {
+  for (auto& list : state->containerCache) {
+    uint32_t toRelease = all ? list.count : list.lowWater;
+    for (uint32_t i = 0; i < toRelease; i++) {
+      auto* container = list.head;
+      list.head = container->nextLink();
+#if USE_NURSERY
+      if (container->nursery())
+        releaseNurseryContainer(state, container);
       else
-        previous->setNextLink(container->nextLink());
-      state->finalizerQueueSize--;
-      memset(container, 0, size);
-      break;
+#endif  // USE_NURSERY
+      konanFreeMemory(container);
     }
-    previous = container;
-    container = container->nextLink();
+    list.count -= toRelease;
+    list.lowWater = list.count;
   }
-#endif
-  if (result == nullptr) {
+}
+#endif  // USE_GC
+
+// Only single object containers may be recycled, as the cache includes the nursery ones.
+ContainerHeader* allocContainer(MemoryState* state, size_t size, bool recycle) {
+  ContainerHeader* result = nullptr;
 #if USE_GC
-    if (state != nullptr)
-        state->allocSinceLastGc += size;
+  if (state != nullptr) {
+    state->allocSinceLastGc += size;
+    // Recently freed container of the same size class is reused without calling into the allocator.
+    if (recycle) result = popCachedContainer(state, size);
+    if (result != nullptr) {
+      MEMORY_LOG("recycle %p for request %d\n", result, size)
+    }
+  }
 #endif
-    result = konanConstructSizedInstance<ContainerHeader>(alignUp(size, kObjectAlignment));
+  if (result == nullptr)
+    result = reinterpret_cast<ContainerHeader*>(allocOwnedMemory(state, alignUp(size, kObjectAlignment)));
+  if (result != nullptr)
     atomicAdd(&allocCount, 1);
+  if (state != nullptr) {
+    CONTAINER_ALLOC_EVENT(state, size, result);
+#if TRACE_MEMORY
+    state->containers->insert(result);
+#endif
   }
+  return result;
+}
+
+#if USE_LARGE_OBJECT_SPACE
+// Precedes the large container in its mapping.
+struct LargeContainerMapping {
+  size_t mappedSize;
+  // Exact size of the container, as the header saturates at CONTAINER_TAG_GC_MAX_SIZE.
+  size_t containerSize;
+};
+
+inline bool isLargeContainer(ContainerHeader* container) {
+  return container->hasContainerSize() && container->containerSize() >= kLargeContainerSize;
+}
+
+inline LargeContainerMapping* largeContainerMapping(ContainerHeader* container) {
+  RuntimeAssert(isLargeContainer(container), "Must be a large container");
+  return reinterpret_cast<LargeContainerMapping*>(container) - 1;
+}
+
+/**
+ * Large containers are mapped directly from the OS, bypassing the allocator and the container caches.
+ * Pages come zeroed and are returned to the OS as soon as the container is freed, and on Linux the mapping
+ * could grow in place, see TryGrowArrayInPlace().
+ */
+ContainerHeader* allocLargeContainer(MemoryState* state, size_t size) {
+  size_t mappedSize = (sizeof(LargeContainerMapping) + size + kLargeContainerPageSize - 1) &
+      ~(kLargeContainerPageSize - 1);
+  auto* mapping = reinterpret_cast<LargeContainerMapping*>(konan::mapMemory(mappedSize));
+  if (mapping == nullptr) return nullptr;
+  mapping->mappedSize = mappedSize;
+  mapping->containerSize = size;
+  auto* result = reinterpret_cast<ContainerHeader*>(mapping + 1);
+  atomicAdd(&allocCount, 1);
   if (state != nullptr) {
+#if USE_GC
+    state->allocSinceLastGc += size;
+    state->gcStatistics.bytesAllocated += size;
+#endif  // USE_GC
     CONTAINER_ALLOC_EVENT(state, size, result);
 #if TRACE_MEMORY
     state->containers->insert(result);
 #endif
   }
+  MEMORY_LOG("large container %p of %zu bytes\n", result, size)
+  return result;
+}
+
+void freeLargeContainer(ContainerHeader* container) {
+  auto* mapping = largeContainerMapping(container);
+  konan::unmapMemory(mapping, mapping->mappedSize);
+}
+#endif  // USE_LARGE_OBJECT_SPACE
+
+// Amount of memory taken by the single object container, as accounted in GC statistics.
+inline size_t objectContainerSize(ContainerHeader* container) {
+#if USE_LARGE_OBJECT_SPACE
+  if (isLargeContainer(container))
+    return largeContainerMapping(container)->containerSize;
+#endif  // USE_LARGE_OBJECT_SPACE
+  return container->containerSize();
+}
+
+// Allocates container for a single object or array.
+inline ContainerHeader* allocObjectContainer(MemoryState* state, container_size_t size) {
+#if USE_LARGE_OBJECT_SPACE
+  if (size >= kLargeContainerSize)
+    return allocLargeContainer(state, size);
+#endif  // USE_LARGE_OBJECT_SPACE
+  ContainerHeader* result = nullptr;
+#if USE_NURSERY
+  // Recycled containers go first, see allocContainer().
+  if (state != nullptr && size <= kNurseryMaxContainerSize && !hasCachedContainer(state, size))
+    result = allocNurseryContainer(state, size);
+#endif  // USE_NURSERY
+  if (result == nullptr)
+    result = allocContainer(state, size, true);
+#if USE_GC
+  // Same as containerSize() recorded in the header, so that it matches the amount released.
+  if (state != nullptr)
+    state->gcStatistics.bytesAllocated += size < CONTAINER_TAG_GC_MAX_SIZE ? size : CONTAINER_TAG_GC_MAX_SIZE;
+#endif  // USE_GC
   return result;
 }
 
 ContainerHeader* allocAggregatingFrozenContainer(KStdVector<ContainerHeader*>& containers) {
   auto componentSize = containers.size();
-  auto* superContainer = allocContainer(memoryState, sizeof(ContainerHeader) + sizeof(void*) * componentSize);
+  auto* superContainer = allocContainer(
+      memoryState, sizeof(ContainerHeader) + sizeof(void*) * componentSize, false);
   auto* place = reinterpret_cast<ContainerHeader**>(superContainer + 1);
   for (auto* container : containers) {
     *place++ = container;
@@ -863,7 +1635,6 @@ ContainerHeader* allocAggregatingFrozenContainer(KStdVector<ContainerHeader*>& c
 #if USE_GC
 
 void processFinalizerQueue(MemoryState* state) {
-  // TODO: reuse elements of finalizer queue for new allocations.
   while (state->finalizerQueue != nullptr) {
     auto* container = state->finalizerQueue;
     state->finalizerQueue = container->nextLink();
@@ -872,7 +1643,19 @@ void processFinalizerQueue(MemoryState* state) {
     state->containers->erase(container);
 #endif
     CONTAINER_DESTROY_EVENT(state, container)
-    konanFreeMemory(container);
+#if USE_LARGE_OBJECT_SPACE
+    if (isLargeContainer(container))
+      freeLargeContainer(container);
+    else
+#endif  // USE_LARGE_OBJECT_SPACE
+    if (!pushCachedContainer(state, container)) {
+#if USE_NURSERY
+      if (container->nursery())
+        releaseNurseryContainer(state, container);
+      else
+#endif  // USE_NURSERY
+      konanFreeMemory(container);
+    }
     atomicAdd(&allocCount, -1);
   }
   RuntimeAssert(state->finalizerQueueSize == 0, "Queue must be empty here");
@@ -904,6 +1687,8 @@ bool hasExternalRefs(ContainerHeader* start, ContainerHeaderSet* visited) {
 void scheduleDestroyContainer(MemoryState* state, ContainerHeader* container) {
 #if USE_GC
   RuntimeAssert(container != nullptr, "Cannot destroy null container");
+  if (container->hasContainerSize())
+    state->gcStatistics.bytesFreed += objectContainerSize(container);
   container->setNextLink(state->finalizerQueue);
   state->finalizerQueue = container;
   state->finalizerQueueSize++;
@@ -913,6 +1698,11 @@ void scheduleDestroyContainer(MemoryState* state, ContainerHeader* container) {
     processFinalizerQueue(state);
   }
 #else
+#if USE_LARGE_OBJECT_SPACE
+  if (isLargeContainer(container))
+    freeLargeContainer(container);
+  else
+#endif  // USE_LARGE_OBJECT_SPACE
   konanFreeMemory(container);
   atomicAdd(&allocCount, -1);
   CONTAINER_DESTROY_EVENT(state, container);
@@ -963,9 +1753,25 @@ ALWAYS_INLINE void runDeallocationHooks(ContainerHeader* container) {
   }
 }
 
+#if USE_CONCURRENT_MARK
+inline bool deferFreeIfConcurrentMark(MemoryState* state, ContainerHeader* container) {
+  if (state == nullptr || !state->concurrentMarkInFlight || !isFreeable(container))
+    return false;
+  MEMORY_LOG("deferring free of %p until concurrent mark is done\n", container)
+  state->deferredFree->push_back(container);
+  return true;
+}
+#endif  // USE_CONCURRENT_MARK
+
 void freeContainer(ContainerHeader* container) {
   RuntimeAssert(container != nullptr, "this kind of container shalln't be freed");
 
+#if USE_CONCURRENT_MARK
+  // Marker thread may still look at this container.
+  if (deferFreeIfConcurrentMark(memoryState, container))
+    return;
+#endif  // USE_CONCURRENT_MARK
+
   if (isAggregatingFrozenContainer(container)) {
     freeAggregatingFrozenContainer(container);
     return;
@@ -1175,26 +1981,96 @@ inline void enqueueDecrementRC(ContainerHeader* container) {
 
 inline void initGcThreshold(MemoryState* state, uint32_t gcThreshold) {
   state->gcThreshold = gcThreshold;
-  state->toRelease->reserve(gcThreshold);
 }
 
 inline void initGcCollectCyclesThreshold(MemoryState* state, uint64_t gcCollectCyclesThreshold) {
   state->gcCollectCyclesThreshold = gcCollectCyclesThreshold;
-  state->toFree->reserve(gcCollectCyclesThreshold);
 }
 
-inline void increaseGcThreshold(MemoryState* state) {
-  auto newThreshold = state->gcThreshold * 3 / 2 + 1;
-  if (newThreshold <= kMaxErgonomicThreshold) {
-    initGcThreshold(state, newThreshold);
+// Estimated size of the heap allocated by the worker.
+inline int64_t heapBytesOf(MemoryState* state) {
+  auto& statistics = state->gcStatistics;
+  return statistics.bytesAllocated > statistics.bytesFreed ? statistics.bytesAllocated - statistics.bytesFreed : 0;
+}
+
+// Scales `value` by `factor`, but does not cross the bound in the direction of change, unless already beyond it.
+inline uint64_t scaleThreshold(uint64_t value, double factor, uint64_t lowerBound, uint64_t upperBound) {
+  if (factor > 1) {
+    uint64_t scaled = value * factor + 1;
+    return value >= upperBound ? value : (scaled < upperBound ? scaled : upperBound);
   }
+  uint64_t scaled = value * factor;
+  return value <= lowerBound ? value : (scaled > lowerBound ? scaled : lowerBound);
 }
 
-inline void increaseGcCollectCyclesThreshold(MemoryState* state) {
-  auto newThreshold = state->gcCollectCyclesThreshold * 2;
-  if (newThreshold <= kMaxErgonomicToFreeSizeThreshold) {
-    initGcCollectCyclesThreshold(state, newThreshold);
+/**
+ * GC pacing, adjusts thresholds after every collection, if autotune is on.
+ * If heap target is set and next collection is expected to overshoot it, thresholds are decreased, so that heap
+ * grows no more than the space left. Expected heap growth is allocation threshold times survival rate, i.e.
+ * which part of bytes allocated since previous collection remained live after this one.
+ * Otherwise thresholds are moved up and down to keep smoothed fraction of time spent in GC close to the target:
+ * bigger thresholds mean less frequent collections. When GC is cheap, thresholds only shrink back to defaults,
+ * as more frequent collections only make sense to keep the heap target.
+ */
+void paceGc(MemoryState* state, uint64_t gcDuration, uint64_t mutatorDuration, uint64_t allocated,
+            uint64_t stackReferences) {
+  auto overhead = double(gcDuration) / (gcDuration + mutatorDuration + 1);
+  state->gcOverhead = state->gcOverhead * (1 - kGcPacingSmoothing) + overhead * kGcPacingSmoothing;
+  auto heapBytes = heapBytesOf(state);
+  auto survivalRate = allocated > 0 ? double(heapBytes - state->lastHeapBytes) / allocated : 1.0;
+  if (survivalRate < kGcPacingMinSurvivalRate) survivalRate = kGcPacingMinSurvivalRate;
+  if (survivalRate > 1) survivalRate = 1;
+  state->lastHeapBytes = heapBytes;
+
+  double factor = 1;
+  uint64_t minThreshold = kGcThreshold;
+  uint64_t minAllocThreshold = kMaxGcAllocThreshold;
+  auto target = state->gcTargetHeapBytes;
+  auto expectedGrowth = survivalRate * state->allocSinceLastGcThreshold;
+  if (target > 0 && heapBytes + expectedGrowth > target) {
+    auto room = uint64_t(heapBytes) < target ? target - heapBytes : 0;
+    factor = room / expectedGrowth;
+    if (factor < 1 / kGcPacingMaxStep) factor = 1 / kGcPacingMaxStep;
+    minThreshold = kMinErgonomicThreshold;
+    minAllocThreshold = kMinErgonomicAllocThreshold;
+  } else if (state->gcOverhead > state->gcTargetOverhead * kGcPacingTolerance) {
+    factor = state->gcOverhead / state->gcTargetOverhead;
+    if (factor > kGcPacingMaxStep) factor = kGcPacingMaxStep;
+    // Do not grow over the heap target, but never shrink either, as collections are too expensive already.
+    if (target > 0 && heapBytes + expectedGrowth * factor > target) {
+      factor = (target - heapBytes) / expectedGrowth;
+      if (factor < 1) factor = 1;
+    }
+  } else if (state->gcOverhead * kGcPacingTolerance < state->gcTargetOverhead) {
+    factor = state->gcOverhead / state->gcTargetOverhead;
+    if (factor < 1 / kGcPacingMaxStep) factor = 1 / kGcPacingMaxStep;
+  }
+  // Too many stack references make collections useless.
+  if (minThreshold < stackReferences * 5) minThreshold = stackReferences * 5;
+  if (factor == 1 && state->gcThreshold >= minThreshold) return;
+
+  initGcThreshold(state, scaleThreshold(state->gcThreshold, factor, minThreshold, kMaxErgonomicThreshold));
+  if (state->gcThreshold < minThreshold && minThreshold <= kMaxErgonomicThreshold)
+    initGcThreshold(state, minThreshold);
+  state->allocSinceLastGcThreshold = scaleThreshold(
+      state->allocSinceLastGcThreshold, factor, minAllocThreshold, kMaxErgonomicAllocThreshold);
+  GC_LOG("Adjusting GC thresholds to %d and %lld: overhead = %f heap = %lld survival = %f\n",
+      state->gcThreshold, state->allocSinceLastGcThreshold, state->gcOverhead, heapBytes, survivalRate)
+}
+
+// Same as paceGc(), for the cycle collector, based on the ratio of cycles collection time to the program time.
+inline void paceCollectCycles(MemoryState* state, uint64_t cyclicGcDuration, uint64_t mutatorDuration) {
+  auto load = double(cyclicGcDuration) / (mutatorDuration + 1);
+  if (cyclicGcDuration > kGcCollectCyclesMinimumDuration && load > kGcCollectCyclesLoadRatio) {
+    initGcCollectCyclesThreshold(state, scaleThreshold(
+        state->gcCollectCyclesThreshold, 2, kMaxToFreeSizeThreshold, kMaxErgonomicToFreeSizeThreshold));
+  } else if (load * kGcPacingMaxStep * kGcPacingMaxStep < kGcCollectCyclesLoadRatio) {
+    initGcCollectCyclesThreshold(state, scaleThreshold(
+        state->gcCollectCyclesThreshold, 0.5, kMaxToFreeSizeThreshold, kMaxErgonomicToFreeSizeThreshold));
+  } else {
+    return;
   }
+  GC_LOG("Adjusting GC collecting cycles threshold to %lld\n", state->gcCollectCyclesThreshold);
 }
 
 #endif // USE_GC
@@ -1267,15 +2143,17 @@ void dumpReachable(const char* prefix, const ContainerHeaderSet* roots) {
 
 #if USE_GC
 
-void markRoots(MemoryState*);
+void markRoots(MemoryState*, size_t);
 void scanRoots(MemoryState*);
 void collectRoots(MemoryState*);
 void scan(ContainerHeader* container);
 
+// Returns number of containers visited.
 template <bool useColor>
-void markGray(ContainerHeader* start) {
+size_t markGray(ContainerHeader* start) {
   ContainerHeaderDeque toVisit;
   toVisit.push_front(start);
+  size_t visited = 0;
 
   while (!toVisit.empty()) {
     auto* container = toVisit.front();
@@ -1294,6 +2172,7 @@ void markGray(ContainerHeader* start) {
       if (container->marked()) continue;
       container->mark();
     }
+    visited++;
 
     traverseContainerReferredObjects(container, [&toVisit](ObjHeader* ref) {
       auto* childContainer = ref->container();
@@ -1304,6 +2183,7 @@ void markGray(ContainerHeader* start) {
       }
     });
   }
+  return visited;
 }
 
 template <bool useColor>
@@ -1342,26 +2222,38 @@ void scanBlack(ContainerHeader* start) {
 
 void collectWhite(MemoryState*, ContainerHeader* container);
 
-void collectCycles(MemoryState* state) {
-  markRoots(state);
+/**
+ * Collects cycles using candidates from the end of toFree list, until markGray() has visited `budget` containers,
+ * remaining candidates stay in the list. Work of scan() and collectWhite() is bounded by the containers marked gray,
+ * so the budget limits the whole slice, except for a single candidate reaching more than `budget` containers.
+ * Any subset of candidates could be used as roots, as trial deletion only finds garbage reachable from the given roots.
+ * Candidates outside of the processed slice could still be found to be garbage by collectWhite(): such containers
+ * are released, but not destroyed until taken out of the list, see markRoots().
+ */
+void collectCycles(MemoryState* state, size_t budget) {
+  GCTraceScope traceScope("collectCycles");
+  markRoots(state, budget);
   scanRoots(state);
   collectRoots(state);
-  state->toFree->clear();
   state->roots->clear();
 }
 
-void markRoots(MemoryState* state) {
-  for (auto container : *(state->toFree)) {
-    if (isMarkedAsRemoved(container))
-      continue;
+void markRoots(MemoryState* state, size_t budget) {
+  auto* toFree = state->toFree;
+  size_t visited = 0;
+  while (toFree->size() > 0 && visited < budget) {
+    // Taken candidate is no longer needed in the list, as roots are kept in their own list.
+    auto* container = toFree->back();
+    toFree->pop_back();
     // Acyclic containers cannot be in this list.
     RuntimeCheck(container->color() != CONTAINER_TAG_GC_GREEN, "Must not be green");
     auto color = container->color();
     auto rcIsZero = container->refCount() == 0;
     if (color == CONTAINER_TAG_GC_PURPLE && !rcIsZero) {
-      markGray<true>(container);
+      visited += markGray<true>(container);
       state->roots->push_back(container);
     } else {
+      visited++;
       container->resetBuffered();
       RuntimeAssert(color != CONTAINER_TAG_GC_GREEN, "Must not be green");
       if (color == CONTAINER_TAG_GC_BLACK && rcIsZero) {
@@ -1383,7 +2275,12 @@ void collectRoots(MemoryState* state) {
   state->gcSuspendCount++;
   for (auto* container : *(state->roots)) {
     container->resetBuffered();
-    collectWhite(state, container);
+    if (container->color() == CONTAINER_TAG_GC_BLACK && container->refCount() == 0) {
+      // Already released by collectWhite() from another root.
+      scheduleDestroyContainer(state, container);
+    } else {
+      collectWhite(state, container);
+    }
   }
   state->gcSuspendCount--;
 }
@@ -1418,7 +2315,7 @@ void collectWhite(MemoryState* state, ContainerHeader* start) {
    while (!toVisit.empty()) {
      auto* container = toVisit.front();
      toVisit.pop_front();
-     if (container->color() != CONTAINER_TAG_GC_WHITE || container->buffered()) continue;
+     if (container->color() != CONTAINER_TAG_GC_WHITE) continue;
      container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
      traverseContainerObjectFields(container, [state, &toVisit](ObjHeader** location) {
         auto* ref = *location;
@@ -1432,68 +2329,554 @@ void collectWhite(MemoryState* state, ContainerHeader* start) {
         }
      });
      runDeallocationHooks(container);
-     scheduleDestroyContainer(state, container);
+     // Buffered container is still referenced from the candidates list, and destroyed once taken out of it.
+     if (!container->buffered())
+       scheduleDestroyContainer(state, container);
   }
 }
 #endif
 
-inline bool needAtomicAccess(ContainerHeader* container) {
-  return container->shareable();
-}
+#if USE_CONCURRENT_MARK
 
-inline bool canBeCyclic(ContainerHeader* container) {
-  if (container->refCount() == 1) return false;
-  if (container->color() == CONTAINER_TAG_GC_GREEN) return false;
-  return true;
-}
+/**
+ * Concurrent mark phase of the trial deletion cycle collector.
+ *
+ * Synchronous mark (markGray() and scan()) visits everything reachable from the candidate roots, so the pause
+ * is proportional to the size of the live graph rather than to the amount of cyclic garbage.
+ * In concurrent mode we take a snapshot of candidate roots and hand it over to the marker thread, which computes
+ * inner reference counts of the transitive closure of the roots in a side table, without touching container headers
+ * (same approach as the one used by the cyclic collector for atomic references, see CyclicCollector.cpp).
+ * Containers whose inner reference count does not match the actual one, and everything reachable from them,
+ * are live, the rest are garbage candidates.
+ * As mutator keeps running, the marker result is only an estimation, so the final phase re-checks candidates
+ * on the mutator thread during GC, where reference counters are precise. It is enough to only count references
+ * coming from the candidate set itself, thus the final phase is proportional to the amount of garbage found.
+ * To keep containers seen by the marker valid, while mark is in flight containers are not released, but put to
+ * the deferred list instead, processed after the final phase. Operations changing ownership of containers
+ * (freezing, sharing and transfer to another worker) abort the concurrent mark.
+ * Write barrier in heap reference updates ensures that marker observes initialized object once a reference
+ * to it is published.
+ */
+class ConcurrentMarker {
+ public:
+  static ConcurrentMarker* create(ContainerHeaderSegmentPool* pool) {
+    return konanConstructInstance<ConcurrentMarker>(pool);
+  }
 
-inline void addHeapRef(ContainerHeader* container) {
-  MEMORY_LOG("AddHeapRef %p: rc=%d\n", container, container->refCount())
-  UPDATE_ADDREF_STAT(memoryState, container, needAtomicAccess(container), 0)
-  switch (container->tag()) {
-    case CONTAINER_TAG_STACK:
-      break;
-    case CONTAINER_TAG_LOCAL:
-      incrementRC</* Atomic = */ false>(container);
-      break;
-    /* case CONTAINER_TAG_FROZEN: case CONTAINER_TAG_SHARED: */
-    default:
-      incrementRC</* Atomic = */ true>(container);
-      break;
+  explicit ConcurrentMarker(ContainerHeaderSegmentPool* pool) : roots_(pool) {
+    RuntimeCheck(pthread_mutex_init(&lock_, nullptr) == 0, "Cannot init marker mutex");
+    RuntimeCheck(pthread_cond_init(&cond_, nullptr) == 0, "Cannot init marker condition");
+    RuntimeCheck(pthread_create(&thread_, nullptr, markerRoutine, this) == 0, "Cannot start marker thread");
   }
-}
 
-inline void addHeapRef(const ObjHeader* header) {
-  auto* container = header->container();
-  if (container != nullptr)
-    addHeapRef(const_cast<ContainerHeader*>(container));
-}
+  ~ConcurrentMarker() {
+    pthread_mutex_lock(&lock_);
+    terminate_ = true;
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&lock_);
+    pthread_join(thread_, nullptr);
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&lock_);
+  }
 
-inline bool tryAddHeapRef(ContainerHeader* container) {
-  switch (container->tag()) {
-    case CONTAINER_TAG_STACK:
-      break;
-    case CONTAINER_TAG_LOCAL:
-      if (!tryIncrementRC</* Atomic = */ false>(container)) return false;
-      break;
-    /* case CONTAINER_TAG_FROZEN: case CONTAINER_TAG_SHARED: */
-    default:
-      if (!tryIncrementRC</* Atomic = */ true>(container)) return false;
-      break;
+  // Hands snapshot of the roots over to the marker thread, `roots` is left empty.
+  void start(ContainerHeaderBuffer* roots) {
+    pthread_mutex_lock(&lock_);
+    RuntimeAssert(!running_, "Marker is already running");
+    roots_.swap(*roots);
+    candidates_.clear();
+    atomicSet(&running_, true);
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&lock_);
   }
 
-  MEMORY_LOG("AddHeapRef %p: rc=%d\n", container, container->refCount() - 1)
-  UPDATE_ADDREF_STAT(memoryState, container, needAtomicAccess(container), 0)
-  return true;
-}
+  bool done() {
+    return !atomicGet(&running_);
+  }
 
-inline bool tryAddHeapRef(const ObjHeader* header) {
-  auto* container = header->container();
-  return (container != nullptr) ? tryAddHeapRef(container) : true;
-}
+  void await() {
+    pthread_mutex_lock(&lock_);
+    while (running_)
+      pthread_cond_wait(&cond_, &lock_);
+    pthread_mutex_unlock(&lock_);
+  }
 
-template <bool Strict>
-inline void releaseHeapRef(ContainerHeader* container) {
+  // Following accessors are only valid once mark is done.
+  ContainerHeaderBuffer* roots() { return &roots_; }
+  ContainerHeaderList* candidates() { return &candidates_; }
+  uint64_t markDuration() const { return markDuration_; }
+
+ private:
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  pthread_t thread_;
+  volatile bool running_ = false;
+  bool terminate_ = false;
+  uint64_t markDuration_ = 0;
+  // Only accessed by the marker thread while mark is running, owned by the mutator otherwise.
+  ContainerHeaderBuffer roots_;
+  ContainerHeaderList candidates_;
+
+  static void* markerRoutine(void* argument) {
+    reinterpret_cast<ConcurrentMarker*>(argument)->markerLoop();
+    return nullptr;
+  }
+
+  void markerLoop() {
+    pthread_mutex_lock(&lock_);
+    while (true) {
+      while (!running_ && !terminate_)
+        pthread_cond_wait(&cond_, &lock_);
+      if (terminate_) break;
+      pthread_mutex_unlock(&lock_);
+      auto markStartTime = konan::getTimeMicros();
+      mark();
+      markDuration_ = konan::getTimeMicros() - markStartTime;
+      pthread_mutex_lock(&lock_);
+      atomicSet(&running_, false);
+      pthread_cond_broadcast(&cond_);
+    }
+    pthread_mutex_unlock(&lock_);
+  }
+
+  // Mutator keeps updating headers of containers and objects seen by the marker, so those are only read
+  // with relaxed atomic loads. Stale values are fine, as the result is re-checked by the mutator anyway.
+  template <typename func>
+  static void traverseReferredContainers(ContainerHeader* container, func process) {
+    auto processField = [process](ObjHeader** location) {
+      // Pairs with the fence in concurrentMarkBarrier().
+      ObjHeader* ref = __atomic_load_n(location, __ATOMIC_ACQUIRE);
+      if (ref == nullptr) return;
+      auto* childContainer = ref->containerRelaxed();
+      if (childContainer != nullptr && !childContainer->shareableRelaxed() && !isArena(childContainer))
+        process(childContainer);
+    };
+    ObjHeader* obj = reinterpret_cast<ObjHeader*>(container + 1);
+    for (unsigned object = 0; object < container->objectCountRelaxed(); object++) {
+      const TypeInfo* typeInfo = obj->typeInfoRelaxed();
+      if (typeInfo != theArrayTypeInfo) {
+        for (int index = 0; index < typeInfo->objOffsetsCount_; index++)
+          processField(reinterpret_cast<ObjHeader**>(reinterpret_cast<uintptr_t>(obj) + typeInfo->objOffsets_[index]));
+      } else {
+        ArrayHeader* array = obj->array();
+        for (int index = 0; index < array->count_; index++)
+          processField(ArrayAddressOfElementAt(array, index));
+      }
+      container_size_t size = typeInfo->instanceSize_ < 0 ?
+          arrayObjectSize(typeInfo, obj->array()->count_) : typeInfo->instanceSize_;
+      obj = reinterpret_cast<ObjHeader*>(reinterpret_cast<uintptr_t>(obj) + alignUp(size, kObjectAlignment));
+    }
+  }
+
+  void mark() {
+    GCTraceScope traceScope("concurrentMark");
+    KStdUnorderedMap<ContainerHeader*, int> innerRefs;
+    ContainerHeaderDeque toVisit;
+    for (auto* root : roots_) {
+      if (innerRefs.emplace(root, 0).second)
+        toVisit.push_back(root);
+    }
+    while (!toVisit.empty()) {
+      auto* container = toVisit.front();
+      toVisit.pop_front();
+      traverseReferredContainers(container, [&innerRefs, &toVisit](ContainerHeader* child) {
+        auto it = innerRefs.emplace(child, 0);
+        it.first->second++;
+        if (it.second) toVisit.push_front(child);
+      });
+    }
+    // Now find containers with external references, and mark everything reachable from them as live
+    // by setting inner reference count to -1.
+    for (auto& it : innerRefs) {
+      if (it.first->refCountRelaxed() != it.second)
+        toVisit.push_back(it.first);
+    }
+    while (!toVisit.empty()) {
+      auto* container = toVisit.front();
+      toVisit.pop_front();
+      auto it = innerRefs.find(container);
+      // Containers unknown to the first pass appeared due to mutations, and will be checked next time.
+      if (it == innerRefs.end() || it->second < 0) continue;
+      it->second = -1;
+      traverseReferredContainers(container, [&toVisit](ContainerHeader* child) {
+        toVisit.push_front(child);
+      });
+    }
+    for (auto& it : innerRefs) {
+      if (it.second >= 0)
+        candidates_.push_back(it.first);
+    }
+  }
+};
+
+void processDeferredFree(MemoryState* state) {
+  RuntimeAssert(!state->concurrentMarkInFlight, "Concurrent mark must be done");
+  auto* deferredFree = state->deferredFree;
+  // Releasing fields of freed containers shall not trigger new GC.
+  state->gcSuspendCount++;
+  while (deferredFree->size() > 0) {
+    auto* container = deferredFree->back();
+    deferredFree->pop_back();
+    freeContainer(container);
+  }
+  state->gcSuspendCount--;
+}
+
+void startConcurrentMark(MemoryState* state) {
+  RuntimeAssert(!state->concurrentMarkInFlight, "Concurrent mark is already in flight");
+  // Same as markRoots(), but trial decrements are computed by the marker thread in the side table.
+  auto* roots = state->roots;
+  for (auto* container : *(state->toFree)) {
+    RuntimeCheck(container->color() != CONTAINER_TAG_GC_GREEN, "Must not be green");
+    auto color = container->color();
+    auto rcIsZero = container->refCount() == 0;
+    container->resetBuffered();
+    if (color == CONTAINER_TAG_GC_PURPLE && !rcIsZero) {
+      // Root is now processed, so that subsequent decrements make it a candidate again.
+      container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
+      roots->push_back(container);
+    } else if (color == CONTAINER_TAG_GC_BLACK && rcIsZero) {
+      scheduleDestroyContainer(state, container);
+    }
+  }
+  state->toFree->clear();
+  if (roots->size() == 0) return;
+
+  GC_LOG("||| GC: starting concurrent mark with %d roots\n", roots->size())
+  if (state->concurrentMarker == nullptr)
+    state->concurrentMarker = ConcurrentMarker::create(state->segmentPool);
+  state->concurrentMarkInFlight = true;
+  state->concurrentMarker->start(roots);
+}
+
+// Final phase of the concurrent mark, requires precise reference counters, i.e. shall only be called
+// after stack increments and pending decrements are processed.
+void collectConcurrentCandidates(MemoryState* state, const ContainerHeaderList* candidates) {
+  KStdUnorderedMap<ContainerHeader*, int> innerRefs;
+  for (auto* container : *candidates) {
+    // Released (deferred), buffered and no longer local containers are left to the regular processing.
+    if (container->local() && !container->buffered() && container->refCount() > 0)
+      innerRefs.emplace(container, 0);
+  }
+  for (auto& it : innerRefs) {
+    traverseContainerReferredObjects(it.first, [&innerRefs](ObjHeader* ref) {
+      auto child = innerRefs.find(ref->container());
+      if (child != innerRefs.end()) child->second++;
+    });
+  }
+  ContainerHeaderDeque toVisit;
+  for (auto& it : innerRefs) {
+    if (it.first->refCount() != it.second)
+      toVisit.push_back(it.first);
+  }
+  while (!toVisit.empty()) {
+    auto* container = toVisit.front();
+    toVisit.pop_front();
+    auto it = innerRefs.find(container);
+    if (it->second < 0) continue;
+    it->second = -1;
+    traverseContainerReferredObjects(container, [&innerRefs, &toVisit](ObjHeader* ref) {
+      auto child = innerRefs.find(ref->container());
+      if (child != innerRefs.end() && child->second >= 0)
+        toVisit.push_front(child->first);
+    });
+  }
+
+  // Everything left is only referenced from within the set, i.e. is cyclic garbage.
+  // References inside the set are just cleared, references leaving the set are released.
+  // Deallocation hooks and destruction are done in a separate pass, as destroyed containers
+  // can no longer be queried for their state.
+  state->gcSuspendCount++;
+  for (auto& it : innerRefs) {
+    if (it.second < 0) continue;
+    traverseContainerObjectFields(it.first, [&innerRefs](ObjHeader** location) {
+      auto* ref = *location;
+      if (ref == nullptr) return;
+      auto child = innerRefs.find(ref->container());
+      if (child != innerRefs.end() && child->second >= 0)
+        *location = nullptr;
+      else
+        ZeroHeapRef(location);
+    });
+  }
+  for (auto& it : innerRefs) {
+    if (it.second < 0) continue;
+    auto* container = it.first;
+    MEMORY_LOG("concurrent mark collects %p\n", container)
+    container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
+    runDeallocationHooks(container);
+    scheduleDestroyContainer(state, container);
+  }
+  state->gcSuspendCount--;
+}
+
+void finishConcurrentMark(MemoryState* state, bool wait) {
+  RuntimeAssert(state->concurrentMarkInFlight, "Concurrent mark must be in flight");
+  auto* marker = state->concurrentMarker;
+  if (!wait && !marker->done()) return;
+  GCTraceScope traceScope("finishConcurrentMark");
+#if PROFILE_GC
+  auto finishStartTime = konan::getTimeMicros();
+#endif
+  marker->await();
+  collectConcurrentCandidates(state, marker->candidates());
+  marker->roots()->clear();
+  marker->candidates()->clear();
+  state->concurrentMarkInFlight = false;
+  state->gcStatistics.cycleCollections++;
+  processDeferredFree(state);
+  processFinalizerQueue(state);
+#if PROFILE_GC
+  GC_LOG("||| GC: concurrentMarkDuration = %lld\n", marker->markDuration());
+  GC_LOG("||| GC: concurrentMarkFinalDuration = %lld\n", konan::getTimeMicros() - finishStartTime);
+#endif
+}
+
+void abortConcurrentMark(MemoryState* state) {
+  if (!state->concurrentMarkInFlight) return;
+  GC_LOG("||| GC: aborting concurrent mark\n")
+  auto* marker = state->concurrentMarker;
+  marker->await();
+  // Return the roots to the candidates list, so that cyclic garbage is not lost.
+  for (auto* container : *marker->roots()) {
+    if (container->local() && !container->buffered()) {
+      container->setColorAssertIfGreen(CONTAINER_TAG_GC_PURPLE);
+      container->setBuffered();
+      state->toFree->push_back(container);
+    }
+  }
+  marker->roots()->clear();
+  marker->candidates()->clear();
+  state->concurrentMarkInFlight = false;
+  processDeferredFree(state);
+}
+
+// Write barrier for the concurrent mark: ensure marker thread sees initialized object,
+// once reference to it is published to the heap.
+ALWAYS_INLINE inline void concurrentMarkBarrier() {
+  auto* state = memoryState;
+  if (state != nullptr && state->concurrentMarkInFlight)
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+#define CONCURRENT_MARK_BARRIER() concurrentMarkBarrier();
+#else
+#define CONCURRENT_MARK_BARRIER()
+#endif  // USE_CONCURRENT_MARK
+
+#if USE_GC_HELPERS
+/**
+ * Helper threads, used to update reference counters of big batches of shareable containers during GC
+ * (stack increments and enqueued decrements). Such counters are atomic anyway, while thread-local containers
+ * are only ever touched by the owner thread. The batch is split evenly between the owner and the helpers.
+ * Helpers never free anything: containers whose counter dropped to zero are handed back to the owner.
+ */
+class GcHelperPool {
+ public:
+  static GcHelperPool* create(int size) {
+    return konanConstructInstance<GcHelperPool>(size);
+  }
+
+  explicit GcHelperPool(int size) : helpers_(size) {
+    RuntimeCheck(pthread_mutex_init(&lock_, nullptr) == 0, "Cannot init helpers mutex");
+    RuntimeCheck(pthread_cond_init(&startCond_, nullptr) == 0, "Cannot init helpers condition");
+    RuntimeCheck(pthread_cond_init(&doneCond_, nullptr) == 0, "Cannot init helpers condition");
+    for (size_t index = 0; index < helpers_.size(); index++) {
+      auto& helper = helpers_[index];
+      helper.pool = this;
+      helper.part = index + 1;
+      RuntimeCheck(pthread_create(&helper.thread, nullptr, helperRoutine, &helper) == 0,
+          "Cannot start GC helper thread");
+    }
+  }
+
+  ~GcHelperPool() {
+    pthread_mutex_lock(&lock_);
+    terminate_ = true;
+    pthread_cond_broadcast(&startCond_);
+    pthread_mutex_unlock(&lock_);
+    for (auto& helper : helpers_)
+      pthread_join(helper.thread, nullptr);
+    pthread_cond_destroy(&doneCond_);
+    pthread_cond_destroy(&startCond_);
+    pthread_mutex_destroy(&lock_);
+  }
+
+  int size() const { return helpers_.size(); }
+
+  // Adds `delta` to reference counters of all `containers`, those with zero counter are added to `released`.
+  void updateRC(ContainerHeader* const* containers, size_t count, int delta, ContainerHeaderList* released) {
+    pthread_mutex_lock(&lock_);
+    containers_ = containers;
+    count_ = count;
+    delta_ = delta;
+    pending_ = helpers_.size();
+    generation_++;
+    pthread_cond_broadcast(&startCond_);
+    pthread_mutex_unlock(&lock_);
+
+    process(0, released);
+
+    pthread_mutex_lock(&lock_);
+    while (pending_ > 0)
+      pthread_cond_wait(&doneCond_, &lock_);
+    pthread_mutex_unlock(&lock_);
+    for (auto& helper : helpers_) {
+      released->insert(released->end(), helper.released.begin(), helper.released.end());
+      helper.released.clear();
+    }
+  }
+
+ private:
+  struct Helper {
+    GcHelperPool* pool;
+    size_t part;
+    pthread_t thread;
+    ContainerHeaderList released;
+  };
+
+  pthread_mutex_t lock_;
+  pthread_cond_t startCond_;
+  pthread_cond_t doneCond_;
+  KStdVector<Helper> helpers_;
+  uint64_t generation_ = 0;
+  size_t pending_ = 0;
+  bool terminate_ = false;
+  ContainerHeader* const* containers_ = nullptr;
+  size_t count_ = 0;
+  int delta_ = 0;
+
+  static void* helperRoutine(void* argument) {
+    auto* helper = reinterpret_cast<Helper*>(argument);
+    helper->pool->helperLoop(helper);
+    return nullptr;
+  }
+
+  void helperLoop(Helper* helper) {
+    uint64_t seenGeneration = 0;
+    pthread_mutex_lock(&lock_);
+    while (true) {
+      while (generation_ == seenGeneration && !terminate_)
+        pthread_cond_wait(&startCond_, &lock_);
+      if (terminate_) break;
+      seenGeneration = generation_;
+      pthread_mutex_unlock(&lock_);
+      process(helper->part, &helper->released);
+      pthread_mutex_lock(&lock_);
+      if (--pending_ == 0)
+        pthread_cond_signal(&doneCond_);
+    }
+    pthread_mutex_unlock(&lock_);
+  }
+
+  void process(size_t part, ContainerHeaderList* released) {
+    size_t parts = helpers_.size() + 1;
+    size_t begin = count_ * part / parts;
+    size_t end = count_ * (part + 1) / parts;
+    for (size_t index = begin; index < end; index++) {
+      auto* container = containers_[index];
+      if (delta_ > 0) {
+        container->incRefCount</* Atomic = */ true>();
+      } else if (container->decRefCount</* Atomic = */ true>() == 0) {
+        released->push_back(container);
+      }
+    }
+  }
+
+  GcHelperPool(const GcHelperPool&) = delete;
+  GcHelperPool& operator=(const GcHelperPool&) = delete;
+};
+
+/**
+ * Adds `delta` to reference counters of shareable containers collected in gcHelperWork, with the help of
+ * helper threads if the batch is big enough, and frees containers no longer referenced.
+ */
+void updateSharedRC(MemoryState* state, int delta) {
+  auto* work = state->gcHelperWork;
+  if (work->size() == 0) return;
+  GCTraceScope traceScope("updateSharedRC");
+  ContainerHeaderList released;
+  if (work->size() >= kGcHelpersMinimumWork) {
+    if (state->gcHelperPool != nullptr && state->gcHelperPool->size() != state->gcHelperCount) {
+      konanDestructInstance(state->gcHelperPool);
+      state->gcHelperPool = nullptr;
+    }
+    if (state->gcHelperPool == nullptr)
+      state->gcHelperPool = GcHelperPool::create(state->gcHelperCount);
+    state->gcHelperPool->updateRC(work->data(), work->size(), delta, &released);
+  } else {
+    for (auto* container : *work) {
+      if (delta > 0) {
+        container->incRefCount</* Atomic = */ true>();
+      } else if (container->decRefCount</* Atomic = */ true>() == 0) {
+        released.push_back(container);
+      }
+    }
+  }
+  work->clear();
+  for (auto* container : released) {
+    freeContainer(container);
+  }
+}
+#endif  // USE_GC_HELPERS
+
+inline bool needAtomicAccess(ContainerHeader* container) {
+  return container->shareable();
+}
+
+inline bool canBeCyclic(ContainerHeader* container) {
+  if (container->refCount() == 1) return false;
+  if (container->color() == CONTAINER_TAG_GC_GREEN) return false;
+  return true;
+}
+
+inline void addHeapRef(ContainerHeader* container) {
+  MEMORY_LOG("AddHeapRef %p: rc=%d\n", container, container->refCount())
+  UPDATE_ADDREF_STAT(memoryState, container, needAtomicAccess(container), 0)
+  switch (container->tag()) {
+    case CONTAINER_TAG_STACK:
+      break;
+    case CONTAINER_TAG_LOCAL:
+      incrementRC</* Atomic = */ false>(container);
+      break;
+    /* case CONTAINER_TAG_FROZEN: case CONTAINER_TAG_SHARED: */
+    default:
+      incrementRC</* Atomic = */ true>(container);
+      break;
+  }
+}
+
+inline void addHeapRef(const ObjHeader* header) {
+  auto* container = header->container();
+  if (container != nullptr)
+    addHeapRef(const_cast<ContainerHeader*>(container));
+}
+
+inline bool tryAddHeapRef(ContainerHeader* container) {
+  switch (container->tag()) {
+    case CONTAINER_TAG_STACK:
+      break;
+    case CONTAINER_TAG_LOCAL:
+      if (!tryIncrementRC</* Atomic = */ false>(container)) return false;
+      break;
+    /* case CONTAINER_TAG_FROZEN: case CONTAINER_TAG_SHARED: */
+    default:
+      if (!tryIncrementRC</* Atomic = */ true>(container)) return false;
+      break;
+  }
+
+  MEMORY_LOG("AddHeapRef %p: rc=%d\n", container, container->refCount() - 1)
+  UPDATE_ADDREF_STAT(memoryState, container, needAtomicAccess(container), 0)
+  return true;
+}
+
+inline bool tryAddHeapRef(const ObjHeader* header) {
+  auto* container = header->container();
+  return (container != nullptr) ? tryAddHeapRef(container) : true;
+}
+
+template <bool Strict>
+inline void releaseHeapRef(ContainerHeader* container) {
   MEMORY_LOG("ReleaseHeapRef %p: rc=%d\n", container, container->refCount())
   UPDATE_RELEASEREF_STAT(memoryState, container, needAtomicAccess(container), canBeCyclic(container), 0)
   if (container->tag() != CONTAINER_TAG_STACK) {
@@ -1539,6 +2922,11 @@ inline size_t containerSize(const ContainerHeader* container) {
 
 #if USE_GC
 void incrementStack(MemoryState* state) {
+  GCTraceScope traceScope("incrementStack");
+#if USE_GC_HELPERS
+  // Increments of shareable containers are postponed, to be split between helper threads.
+  auto* shared = state->gcHelperCount > 0 ? state->gcHelperWork : nullptr;
+#endif  // USE_GC_HELPERS
   FrameOverlay* frame = currentFrame;
   while (frame != nullptr) {
     ObjHeader** current = reinterpret_cast<ObjHeader**>(frame + 1) + frame->parameters;
@@ -1549,6 +2937,12 @@ void incrementStack(MemoryState* state) {
         auto* container = obj->container();
         if (container == nullptr) continue;
         if (container->shareable()) {
+#if USE_GC_HELPERS
+          if (shared != nullptr) {
+            shared->push_back(container);
+            continue;
+          }
+#endif  // USE_GC_HELPERS
           incrementRC<true>(container);
         } else {
           incrementRC<false>(container);
@@ -1557,20 +2951,39 @@ void incrementStack(MemoryState* state) {
     }
     frame = frame->previous;
   }
+#if USE_GC_HELPERS
+  updateSharedRC(state, 1);
+#endif  // USE_GC_HELPERS
 }
 
 void processDecrements(MemoryState* state) {
   RuntimeAssert(IsStrictMemoryModel, "Only works in strict model now");
+  GCTraceScope traceScope("processDecrements");
   auto* toRelease = state->toRelease;
   state->gcSuspendCount++;
+#if USE_GC_HELPERS
+  // Decrements of shareable containers are postponed, to be split between helper threads.
+  auto* shared = state->gcHelperCount > 0 ? state->gcHelperWork : nullptr;
+#endif  // USE_GC_HELPERS
   while (toRelease->size() > 0) {
-     auto* container = toRelease->back();
-     toRelease->pop_back();
-     if (isMarkedAsRemoved(container))
-       continue;
-     if (container->shareable())
-       container = realShareableContainer(container);
-     decrementRC(container);
+    while (toRelease->size() > 0) {
+       auto* container = toRelease->back();
+       toRelease->pop_back();
+       if (container->shareable()) {
+         container = realShareableContainer(container);
+#if USE_GC_HELPERS
+         if (shared != nullptr) {
+           shared->push_back(container);
+           continue;
+         }
+#endif  // USE_GC_HELPERS
+       }
+       decrementRC(container);
+    }
+#if USE_GC_HELPERS
+    // Freeing containers may enqueue more decrements.
+    updateSharedRC(state, -1);
+#endif  // USE_GC_HELPERS
   }
 
   state->foreignRefManager->processEnqueuedReleaseRefsWith([](ObjHeader* obj) {
@@ -1582,6 +2995,7 @@ void processDecrements(MemoryState* state) {
 
 void decrementStack(MemoryState* state) {
   RuntimeAssert(IsStrictMemoryModel, "Only works in strict model now");
+  GCTraceScope traceScope("decrementStack");
   state->gcSuspendCount++;
   FrameOverlay* frame = currentFrame;
   while (frame != nullptr) {
@@ -1601,15 +3015,48 @@ void decrementStack(MemoryState* state) {
   state->gcSuspendCount--;
 }
 
+/**
+ * Returns memory cached by the worker for reuse to the allocator, and memory the allocator does not use to the OS,
+ * so that resident size of the process follows the heap size.
+ * Returns by how much the estimated heap size has shrunk since its peak, i.e. an upper bound of the memory returned.
+ */
+int64_t trimHeap(MemoryState* state) {
+  GCTraceScope traceScope("trimHeap");
+  trimContainerCache(state, true);
+  // Heap of the worker is only known to the allocator, when it's called by the owner thread.
+  konan::trimHeap(state == ::memoryState ? state->heap : nullptr);
+  auto heapBytes = heapBytesOf(state);
+  state->lastTrimBytes = state->peakHeapBytes > heapBytes ? state->peakHeapBytes - heapBytes : 0;
+  state->peakHeapBytes = heapBytes;
+  state->lastTrimTimestamp = konan::getTimeMicros();
+  return state->lastTrimBytes;
+}
+
+// Trims the heap after collection, if it has shrunk considerably since its peak, e.g. after a spike of allocations.
+void maybeTrimHeap(MemoryState* state, uint64_t now) {
+  if (!state->gcAutoTrim || now - state->lastTrimTimestamp < kAutoTrimIntervalMicros) return;
+  auto heapBytes = heapBytesOf(state);
+  if (state->peakHeapBytes - heapBytes < kAutoTrimMinBytes ||
+      heapBytes > state->peakHeapBytes * kAutoTrimHeapFraction) return;
+  GC_LOG("Trimming heap: %lld bytes, peak %lld bytes\n", heapBytes, state->peakHeapBytes)
+  trimHeap(state);
+}
+
 void garbageCollect(MemoryState* state, bool force) {
   RuntimeAssert(!state->gcInProgress, "Recursive GC is disallowed");
+  GCTraceScope traceScope(force ? "garbageCollect (forced)" : "garbageCollect");
 
   uint64_t allocSinceLastGc = state->allocSinceLastGc;
   state->allocSinceLastGc = 0;
+  auto heapBytesBefore = heapBytesOf(state);
+  if (heapBytesBefore > state->peakHeapBytes)
+    state->peakHeapBytes = heapBytesBefore;
 
   if (!IsStrictMemoryModel) {
     // In relaxed model we just process finalizer queue and be done with it.
     processFinalizerQueue(state);
+    trimContainerCache(state, force);
+    maybeTrimHeap(state, konan::getTimeMicros());
     return;
   }
 
@@ -1645,61 +3092,80 @@ void garbageCollect(MemoryState* state, bool force) {
   auto decrementStackDuration = konan::getTimeMicros() - decrementStackStartTime;
   GC_LOG("||| GC: decrementStackDuration = %lld\n", decrementStackDuration);
 #endif
-  long stackReferences = afterDecrements - beforeDecrements;
-  if (state->gcErgonomics && stackReferences * 5 > state->gcThreshold) {
-    increaseGcThreshold(state);
-    GC_LOG("||| GC: too many stack references, increased threshold to %d\n", state->gcThreshold);
-  }
+  size_t stackReferences = afterDecrements - beforeDecrements;
 
   GC_LOG("||| GC: toFree %d toRelease %d\n", state->toFree->size(), state->toRelease->size())
 #if PROFILE_GC
   auto processFinalizerQueueStartTime = konan::getTimeMicros();
 #endif
+  gcTraceBegin("processFinalizerQueue");
   processFinalizerQueue(state);
+  gcTraceEnd("processFinalizerQueue");
 #if PROFILE_GC
   auto processFinalizerQueueDuration = konan::getTimeMicros() - processFinalizerQueueStartTime;
   GC_LOG("||| GC: processFinalizerQueueDuration %lld\n", processFinalizerQueueDuration);
 #endif
 
-  if (force || state->toFree->size() > state->gcCollectCyclesThreshold) {
+#if USE_CONCURRENT_MARK
+  if (state->concurrentMarkInFlight) {
+    // Only wait for the marker thread if collection is forced.
+    finishConcurrentMark(state, force);
+  }
+  if (state->gcConcurrentMark && !force) {
+    if (!state->concurrentMarkInFlight && state->toFree->size() > state->gcCollectCyclesThreshold)
+      startConcurrentMark(state);
+  } else
+#endif  // USE_CONCURRENT_MARK
+  if (force || state->gcCollectCyclesPending || state->toFree->size() > state->gcCollectCyclesThreshold) {
     auto cyclicGcStartTime = konan::getTimeMicros();
+    // Forced collection ignores the pause budget.
+    bool incremental = !force && state->gcMaxPauseMicros > 0;
+    state->gcCollectCyclesPending = false;
     while (state->toFree->size() > 0) {
-      collectCycles(state);
+      collectCycles(state, incremental ? kGcCollectCyclesSliceObjects : std::numeric_limits<size_t>::max());
       #if PROFILE_GC
         processFinalizerQueueStartTime = konan::getTimeMicros();
       #endif
+      gcTraceBegin("processFinalizerQueue");
       processFinalizerQueue(state);
+      gcTraceEnd("processFinalizerQueue");
       #if PROFILE_GC
         processFinalizerQueueDuration += konan::getTimeMicros() - processFinalizerQueueStartTime;
         GC_LOG("||| GC: processFinalizerQueueDuration = %lld\n", processFinalizerQueueDuration);
       #endif
+      if (incremental && state->toFree->size() > 0 &&
+          konan::getTimeMicros() - gcStartTime >= state->gcMaxPauseMicros) {
+        GC_LOG("||| GC: out of pause budget, %d cycle candidates left\n", state->toFree->size())
+        state->gcCollectCyclesPending = true;
+        break;
+      }
     }
     auto cyclicGcEndTime = konan::getTimeMicros();
     #if PROFILE_GC
       GC_LOG("||| GC: collectCyclesDuration = %lld\n", cyclicGcEndTime - cyclicGcStartTime);
     #endif
     auto cyclicGcDuration = cyclicGcEndTime - cyclicGcStartTime;
-    if (state->gcErgonomics && cyclicGcDuration > kGcCollectCyclesMinimumDuration &&
-        double(cyclicGcDuration) / (cyclicGcStartTime - state->lastCyclicGcTimestamp + 1) > kGcCollectCyclesLoadRatio) {
-      increaseGcCollectCyclesThreshold(state);
-      GC_LOG("Adjusting GC collecting cycles threshold to %lld\n", state->gcCollectCyclesThreshold);
-    }
+    state->gcStatistics.cycleCollections++;
+    if (state->gcErgonomics)
+      paceCollectCycles(state, cyclicGcDuration, cyclicGcStartTime - state->lastCyclicGcTimestamp);
     state->lastCyclicGcTimestamp = cyclicGcEndTime;
   }
 
+  // Forced collection returns all the cached memory to the allocator.
+  trimContainerCache(state, force);
+
   state->gcInProgress = false;
   auto gcEndTime = konan::getTimeMicros();
+  state->gcStatistics.recordPause(gcEndTime - gcStartTime);
 
   if (state->gcErgonomics) {
-    auto gcToComputeRatio = double(gcEndTime - gcStartTime) / (gcStartTime - state->lastGcTimestamp + 1);
-    if (gcToComputeRatio > kGcToComputeRatioThreshold) {
-      increaseGcThreshold(state);
-      GC_LOG("Adjusting GC threshold to %d\n", state->gcThreshold);
-    }
+    paceGc(state, gcEndTime - gcStartTime, gcStartTime - state->lastGcTimestamp, allocSinceLastGc, stackReferences);
   }
   GC_LOG("GC: gcToComputeRatio=%f duration=%lld sinceLast=%lld\n", double(gcEndTime - gcStartTime) / (gcStartTime - state->lastGcTimestamp + 1), (gcEndTime - gcStartTime), gcStartTime - state->lastGcTimestamp);
   state->lastGcTimestamp = gcEndTime;
 
+  maybeTrimHeap(state, gcEndTime);
+
 #if TRACE_MEMORY
   for (auto* obj: *state->toRelease) {
     MEMORY_LOG("toRelease %p\n", obj)
@@ -1719,6 +3185,16 @@ void rememberNewContainer(ContainerHeader* container) {
   }
 }
 
+// Same as rememberNewContainer(), but for the container just allocated by this thread.
+// Nobody else could see it yet, so no need for atomic increment.
+void rememberFreshContainer(ContainerHeader* container) {
+  if (container == nullptr) return;
+  if (memoryState != nullptr) {
+    incrementRC</* Atomic = */ false>(container);
+    enqueueDecrementRC</* CanCollect = */ true>(container);
+  }
+}
+
 void garbageCollect() {
   garbageCollect(memoryState, true);
 }
@@ -1777,7 +3253,7 @@ void deinitForeignRef(ObjHeader* object, ForeignRefManager* manager) {
   }
 }
 
-MemoryState* initMemory() {
+MemoryState* initMemory(bool threadBound) {
   RuntimeAssert(offsetof(ArrayHeader, typeInfoOrMeta_)
                 ==
                 offsetof(ObjHeader,   typeInfoOrMeta_),
@@ -1790,16 +3266,28 @@ MemoryState* initMemory() {
   RuntimeAssert(memoryState == nullptr, "memory state must be clear");
   memoryState = konanConstructInstance<MemoryState>();
   INIT_EVENT(memoryState)
+  if (threadBound)
+    memoryState->heap = konan::createHeap();
 #if USE_GC
-  memoryState->toFree = konanConstructInstance<ContainerHeaderList>();
-  memoryState->roots = konanConstructInstance<ContainerHeaderList>();
+  memoryState->segmentPool = konanConstructInstance<ContainerHeaderSegmentPool>(memoryState);
+  memoryState->toFree = konanConstructInstance<ContainerHeaderBuffer>(memoryState->segmentPool);
+  memoryState->roots = konanConstructInstance<ContainerHeaderBuffer>(memoryState->segmentPool);
   memoryState->gcInProgress = false;
   memoryState->gcSuspendCount = 0;
-  memoryState->toRelease = konanConstructInstance<ContainerHeaderList>();
+  memoryState->toRelease = konanConstructInstance<ContainerHeaderBuffer>(memoryState->segmentPool);
   initGcThreshold(memoryState, kGcThreshold);
   initGcCollectCyclesThreshold(memoryState, kMaxToFreeSizeThreshold);
   memoryState->allocSinceLastGcThreshold = kMaxGcAllocThreshold;
   memoryState->gcErgonomics = true;
+  memoryState->gcTargetOverhead = kDefaultGcTargetOverhead;
+  memoryState->gcAutoTrim = true;
+  memoryState->lastTrimTimestamp = konan::getTimeMicros();
+#if USE_CONCURRENT_MARK
+  memoryState->deferredFree = konanConstructInstance<ContainerHeaderBuffer>(memoryState->segmentPool);
+#endif  // USE_CONCURRENT_MARK
+#if USE_GC_HELPERS
+  memoryState->gcHelperWork = konanConstructInstance<ContainerHeaderList>();
+#endif  // USE_GC_HELPERS
 #endif
   memoryState->tlsMap = konanConstructInstance<KThreadLocalStorageMap>();
   memoryState->foreignRefManager = ForeignRefManager::create();
@@ -1835,15 +3323,33 @@ void deinitMemory(MemoryState* memoryState) {
     GC_LOG("Calling garbageCollect from DeinitMemory()\n")
     garbageCollect(memoryState, true);
   } while (memoryState->toRelease->size() > 0 || !memoryState->foreignRefManager->tryReleaseRefOwned());
+#if USE_NURSERY
+  retireNurseryChunk(memoryState);
+#endif  // USE_NURSERY
+  gcTraceFlush();
   RuntimeAssert(memoryState->toFree->size() == 0, "Some memory have not been released after GC");
   RuntimeAssert(memoryState->toRelease->size() == 0, "Some memory have not been released after GC");
+#if USE_CONCURRENT_MARK
+  RuntimeAssert(!memoryState->concurrentMarkInFlight, "Concurrent mark must be done");
+  if (memoryState->concurrentMarker != nullptr)
+    konanDestructInstance(memoryState->concurrentMarker);
+  konanDestructInstance(memoryState->deferredFree);
+#endif  // USE_CONCURRENT_MARK
+#if USE_GC_HELPERS
+  if (memoryState->gcHelperPool != nullptr)
+    konanDestructInstance(memoryState->gcHelperPool);
+  konanDestructInstance(memoryState->gcHelperWork);
+#endif  // USE_GC_HELPERS
   konanDestructInstance(memoryState->toFree);
   konanDestructInstance(memoryState->roots);
   konanDestructInstance(memoryState->toRelease);
+  konanDestructInstance(memoryState->segmentPool);
   RuntimeAssert(memoryState->tlsMap->size() == 0, "Must be already cleared");
   konanDestructInstance(memoryState->tlsMap);
   RuntimeAssert(memoryState->finalizerQueue == nullptr, "Finalizer queue must be empty");
   RuntimeAssert(memoryState->finalizerQueueSize == 0, "Finalizer queue must be empty");
+  trimContainerCache(memoryState, true);
+  forgetStablePointers(memoryState);
 #endif // USE_GC
 
   atomicAdd(&pendingDeinit, -1);
@@ -1867,12 +3373,21 @@ void deinitMemory(MemoryState* memoryState) {
   PRINT_EVENT(memoryState)
   DEINIT_EVENT(memoryState)
 
+  if (memoryState->heap != nullptr) {
+    RuntimeAssert(memoryState == ::memoryState, "Heap must be destroyed by its thread");
+    konan::destroyHeap(memoryState->heap);
+  }
   konanFreeMemory(memoryState);
   ::memoryState = nullptr;
 }
 
 MemoryState* suspendMemory() {
     auto result = ::memoryState;
+    // Suspended state could be resumed by another thread, so from now on it allocates in the shared heap.
+    if (result != nullptr && result->heap != nullptr) {
+      konan::destroyHeap(result->heap);
+      result->heap = nullptr;
+    }
     ::memoryState = nullptr;
     return result;
 }
@@ -1901,6 +3416,7 @@ void setHeapRef(ObjHeader** location, const ObjHeader* object) {
   UPDATE_REF_EVENT(memoryState, nullptr, object, location, 0);
   if (object != nullptr)
     addHeapRef(const_cast<ObjHeader*>(object));
+  CONCURRENT_MARK_BARRIER()
   *const_cast<const ObjHeader**>(location) = object;
 }
 
@@ -1934,6 +3450,7 @@ void updateHeapRef(ObjHeader** location, const ObjHeader* object) {
     if (object != nullptr) {
       addHeapRef(object);
     }
+    CONCURRENT_MARK_BARRIER()
     *const_cast<const ObjHeader**>(location) = object;
     if (reinterpret_cast<uintptr_t>(old) > 1) {
       releaseHeapRef<Strict>(old);
@@ -1996,25 +3513,120 @@ inline void checkIfGcNeeded(MemoryState* state) {
   }
 }
 
+#if USE_GC
+void RUNTIME_NORETURN throwOutOfMemoryError(MemoryState* state) {
+  if (state == nullptr) ThrowOutOfMemoryError();
+  state->heapLimitsSuspended = true;
+#if !KONAN_NO_EXCEPTIONS
+  try {
+    ThrowOutOfMemoryError();
+  } catch (...) {
+    state->heapLimitsSuspended = false;
+    throw;
+  }
+#else
+  ThrowOutOfMemoryError();
+#endif
+}
+
+void notifySoftHeapLimit(MemoryState* state, int64_t heapBytes) {
+  state->softHeapLimitNotifying = true;
+#if !KONAN_NO_EXCEPTIONS
+  try {
+    Kotlin_native_internal_GC_notifySoftHeapLimit(heapBytes);
+  } catch (...) {
+    state->softHeapLimitNotifying = false;
+    throw;
+  }
+#else
+  Kotlin_native_internal_GC_notifySoftHeapLimit(heapBytes);
+#endif
+  state->softHeapLimitNotifying = false;
+}
+
+/**
+ * Calls the soft limit handler, or throws OutOfMemoryError, if an earlier object allocation crossed the limit.
+ */
+void raisePendingHeapLimits(MemoryState* state) {
+  if (state == nullptr || state->heapLimitsSuspended || state->gcInProgress) return;
+  if (state->pendingOutOfMemory) {
+    state->pendingOutOfMemory = false;
+    state->pendingSoftHeapLimitBytes = 0;
+    throwOutOfMemoryError(state);
+  }
+  int64_t heapBytes = state->pendingSoftHeapLimitBytes;
+  if (heapBytes == 0 || state->softHeapLimitNotifying) return;
+  state->pendingSoftHeapLimitBytes = 0;
+  notifySoftHeapLimit(state, heapBytes);
+}
+
+/**
+ * Enforces heap limits of the worker before allocating `size` bytes.
+ * Crossing the soft limit forces collection, including cyclic garbage, and if the heap is still above the limit,
+ * calls the handler of the application, so that it could shed load. Collections are then repeated only as the heap
+ * keeps growing, not on every allocation. Crossing the hard limit forces collection as well, and if it does not help,
+ * allocation fails with OutOfMemoryError.
+ * The compiler calls AllocInstance without an exception handler, so with `canThrow` unset the handler and the error
+ * are left pending until the next allocation of an array or explicit collection, and the object is allocated anyway.
+ */
+void checkHeapLimits(MemoryState* state, uint64_t size, bool canThrow) {
+  if (state == nullptr || state->heapLimitsSuspended || state->gcInProgress) return;
+  if (canThrow) {
+    raisePendingHeapLimits(state);
+  } else if (state->pendingOutOfMemory) {
+    return;
+  }
+  if (state->softHeapLimit == 0 && state->hardHeapLimit == 0) return;
+  uint64_t heapBytes = heapBytesOf(state) + size;
+  if (state->hardHeapLimit != 0 && heapBytes > state->hardHeapLimit) {
+    GC_LOG("Calling GC from checkHeapLimits: heap %lld exceeds hard limit\n", heapBytes)
+    garbageCollect(state, true);
+    heapBytes = heapBytesOf(state) + size;
+    if (heapBytes > state->hardHeapLimit) {
+      if (canThrow) throwOutOfMemoryError(state);
+      state->pendingOutOfMemory = true;
+      return;
+    }
+  }
+  if (state->softHeapLimit == 0) return;
+  if (heapBytes <= state->softHeapLimit) {
+    state->softHeapLimitTrigger = state->softHeapLimit;
+    return;
+  }
+  if (heapBytes <= state->softHeapLimitTrigger || state->softHeapLimitNotifying) return;
+  GC_LOG("Calling GC from checkHeapLimits: heap %lld exceeds soft limit\n", heapBytes)
+  garbageCollect(state, true);
+  heapBytes = heapBytesOf(state) + size;
+  if (heapBytes <= state->softHeapLimit) return;
+  state->softHeapLimitTrigger = heapBytes + state->softHeapLimit / kSoftHeapLimitStepDivisor;
+  if (canThrow) {
+    notifySoftHeapLimit(state, heapBytes);
+  } else {
+    state->pendingSoftHeapLimitBytes = heapBytes;
+  }
+}
+#endif  // USE_GC
+
 template <bool Strict>
 OBJ_GETTER(allocInstance, const TypeInfo* type_info) {
   RuntimeAssert(type_info->instanceSize_ >= 0, "must be an object");
   auto* state = memoryState;
 #if USE_GC
   checkIfGcNeeded(state);
+  checkHeapLimits(state, sizeof(ContainerHeader) + type_info->instanceSize_, false);
 #endif  // USE_GC
   auto container = ObjectContainer(state, type_info);
   ObjHeader* obj = container.GetPlace();
 #if USE_GC
   if (Strict) {
-    rememberNewContainer(container.header());
+    rememberFreshContainer(container.header());
   } else {
     makeShareable(container.header());
   }
 #endif  // USE_GC
 #if USE_CYCLIC_GC
   if ((obj->type_info()->flags_ & TF_LEAK_DETECTOR_CANDIDATE) != 0) {
-    // Note: this should be performed after [rememberNewContainer] (above).
+    // Note: this should be performed after [rememberFreshContainer] (above).
     // Otherwise cyclic collector can observe this atomic root with RC = 0,
     // thus consider it garbage and then zero it after initialization.
     cyclicAddAtomicRoot(obj);
@@ -2030,11 +3642,12 @@ OBJ_GETTER(allocArrayInstance, const TypeInfo* type_info, int32_t elements) {
   auto* state = memoryState;
 #if USE_GC
   checkIfGcNeeded(state);
+  checkHeapLimits(state, sizeof(ContainerHeader) + arrayObjectSize(type_info, elements), true);
 #endif  // USE_GC
   auto container = ArrayContainer(state, type_info, elements);
 #if USE_GC
   if (Strict) {
-    rememberNewContainer(container.header());
+    rememberFreshContainer(container.header());
   } else {
     makeShareable(container.header());
   }
@@ -2042,6 +3655,45 @@ OBJ_GETTER(allocArrayInstance, const TypeInfo* type_info, int32_t elements) {
   RETURN_OBJ(container.GetPlace()->obj());
 }
 
+bool tryGrowArrayInPlace(ArrayHeader* array, int32_t newCount) {
+#if USE_LARGE_OBJECT_SPACE
+  if (newCount < 0) ThrowIllegalArgumentException();
+  uint32_t count = array->count_;
+  if (static_cast<uint32_t>(newCount) <= count) return static_cast<uint32_t>(newCount) == count;
+  auto* container = array->obj()->container();
+  // Arrays with the meta object, on stack or frozen stay as they are.
+  if (container != reinterpret_cast<ContainerHeader*>(array) - 1 || container->frozen() ||
+      !isLargeContainer(container))
+    return false;
+  auto* mapping = largeContainerMapping(container);
+  size_t newSize = sizeof(ContainerHeader) + arrayObjectSize(array->type_info(), newCount);
+  size_t delta = newSize - mapping->containerSize;
+  auto* state = memoryState;
+#if USE_GC
+  checkHeapLimits(state, delta, true);
+#endif  // USE_GC
+  size_t newMappedSize = (sizeof(LargeContainerMapping) + newSize + kLargeContainerPageSize - 1) &
+      ~(kLargeContainerPageSize - 1);
+  if (newMappedSize > mapping->mappedSize) {
+    if (!konan::extendMapping(mapping, mapping->mappedSize, newMappedSize)) return false;
+    mapping->mappedSize = newMappedSize;
+  }
+  // Memory after the container is still zero, as it was either never used, or has just been mapped.
+  mapping->containerSize = newSize;
+  container->setContainerSize(newSize);
+  array->count_ = newCount;
+#if USE_GC
+  if (state != nullptr) {
+    state->allocSinceLastGc += delta;
+    state->gcStatistics.bytesAllocated += delta;
+  }
+#endif  // USE_GC
+  return true;
+#else
+  return false;
+#endif  // USE_LARGE_OBJECT_SPACE
+}
+
 template <bool Strict>
 OBJ_GETTER(initInstance,
     ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*)) {
@@ -2300,9 +3952,9 @@ void stopGC() {
 void startGC() {
   GC_LOG("startGC\n")
   if (memoryState->toFree == nullptr) {
-    memoryState->toFree = konanConstructInstance<ContainerHeaderList>();
-    memoryState->toRelease = konanConstructInstance<ContainerHeaderList>();
-    memoryState->roots = konanConstructInstance<ContainerHeaderList>();
+    memoryState->toFree = konanConstructInstance<ContainerHeaderBuffer>(memoryState->segmentPool);
+    memoryState->toRelease = konanConstructInstance<ContainerHeaderBuffer>(memoryState->segmentPool);
+    memoryState->roots = konanConstructInstance<ContainerHeaderBuffer>(memoryState->segmentPool);
     memoryState->gcSuspendCount = 0;
   }
 }
@@ -2357,29 +4009,398 @@ KBoolean getTuneGCThreshold() {
   return memoryState->gcErgonomics;
 }
 
-KNativePtr createStablePointer(KRef any) {
-  if (any == nullptr) return nullptr;
-  MEMORY_LOG("CreateStablePointer for %p rc=%d\n", any, any->container() ? any->container()->refCount() : 0)
-  addHeapRef(any);
-  return reinterpret_cast<KNativePtr>(any);
+void setGCTargetOverhead(KDouble value) {
+  GC_LOG("setGCTargetOverhead %f\n", value)
+  if (!(value > 0 && value < 1)) {
+    ThrowIllegalArgumentException();
+  }
+  memoryState->gcTargetOverhead = value;
 }
 
-void disposeStablePointer(KNativePtr pointer) {
-  if (pointer == nullptr) return;
-  KRef ref = reinterpret_cast<KRef>(pointer);
-  ReleaseHeapRef(ref);
+KDouble getGCTargetOverhead() {
+  GC_LOG("getGCTargetOverhead\n")
+  return memoryState->gcTargetOverhead;
 }
 
-OBJ_GETTER(derefStablePointer, KNativePtr pointer) {
-  KRef ref = reinterpret_cast<KRef>(pointer);
-  AdoptReferenceFromSharedVariable(ref);
-  RETURN_OBJ(ref);
+void setGCTargetHeapBytes(KLong value) {
+  GC_LOG("setGCTargetHeapBytes %lld\n", value)
+  if (value < 0) {
+    ThrowIllegalArgumentException();
+  }
+  memoryState->gcTargetHeapBytes = value;
 }
 
-OBJ_GETTER(adoptStablePointer, KNativePtr pointer) {
-  synchronize();
-  KRef ref = reinterpret_cast<KRef>(pointer);
-  MEMORY_LOG("adopting stable pointer %p, rc=%d\n", \
+KLong getGCTargetHeapBytes() {
+  GC_LOG("getGCTargetHeapBytes\n")
+  return memoryState->gcTargetHeapBytes;
+}
+
+void setGCSoftHeapLimit(KLong value) {
+  GC_LOG("setGCSoftHeapLimit %lld\n", value)
+  auto* state = memoryState;
+  if (value < 0 || (value != 0 && state->hardHeapLimit != 0 && static_cast<uint64_t>(value) > state->hardHeapLimit)) {
+    ThrowIllegalArgumentException();
+  }
+  state->softHeapLimit = value;
+  state->softHeapLimitTrigger = value;
+  state->pendingSoftHeapLimitBytes = 0;
+}
+
+KLong getGCSoftHeapLimit() {
+  GC_LOG("getGCSoftHeapLimit\n")
+  return memoryState->softHeapLimit;
+}
+
+void setGCHardHeapLimit(KLong value) {
+  GC_LOG("setGCHardHeapLimit %lld\n", value)
+  auto* state = memoryState;
+  if (value < 0 || (value != 0 && static_cast<uint64_t>(value) < state->softHeapLimit)) {
+    ThrowIllegalArgumentException();
+  }
+  state->hardHeapLimit = value;
+  state->pendingOutOfMemory = false;
+}
+
+KLong getGCHardHeapLimit() {
+  GC_LOG("getGCHardHeapLimit\n")
+  return memoryState->hardHeapLimit;
+}
+
+void setGCAutoTrim(KBoolean value) {
+  GC_LOG("setGCAutoTrim %d\n", value)
+  memoryState->gcAutoTrim = value;
+}
+
+KBoolean getGCAutoTrim() {
+  GC_LOG("getGCAutoTrim\n")
+  return memoryState->gcAutoTrim;
+}
+
+void getGCStatistics(KRef values) {
+  GC_LOG("getGCStatistics\n")
+  ArrayHeader* array = values->array();
+  RuntimeCheck(array->count_ >= kGcStatCount, "Statistics array is too small");
+  auto* state = memoryState;
+  const auto& statistics = state->gcStatistics;
+  auto* result = AddressOfElementAt<KLong>(array, 0);
+  result[kGcStatCollections] = statistics.collections;
+  result[kGcStatCycleCollections] = statistics.cycleCollections;
+  result[kGcStatTotalPauseMicros] = statistics.totalPauseMicros;
+  result[kGcStatMaxPauseMicros] = statistics.maxPauseMicros;
+  result[kGcStatBytesAllocated] = statistics.bytesAllocated;
+  result[kGcStatBytesFreed] = statistics.bytesFreed;
+  result[kGcStatToFreeSize] = state->toFree->size();
+  result[kGcStatToReleaseSize] = state->toRelease->size();
+  result[kGcStatFinalizerQueueSize] = state->finalizerQueueSize;
+  result[kGcStatFreshTransfers] = statistics.freshTransfers;
+  result[kGcStatNurseryChunksFreed] = statistics.nurseryChunksFreed;
+  result[kGcStatNurseryBytesDiscarded] = statistics.nurseryBytesDiscarded;
+  for (int bucket = 0; bucket < kGcStatPauseHistogramBuckets; bucket++)
+    result[kGcStatPauseHistogram + bucket] = statistics.pauseHistogram[bucket];
+}
+
+KLong getGCHeapBytes() {
+  GC_LOG("getGCHeapBytes\n")
+  return heapBytesOf(memoryState);
+}
+
+void setGCMaxPauseMicros(KLong value) {
+  GC_LOG("setGCMaxPauseMicros %lld\n", value)
+  if (value < 0) {
+    ThrowIllegalArgumentException();
+  }
+  memoryState->gcMaxPauseMicros = value;
+}
+
+KLong getGCMaxPauseMicros() {
+  GC_LOG("getGCMaxPauseMicros\n")
+  return memoryState->gcMaxPauseMicros;
+}
+
+#if USE_CONCURRENT_MARK
+void setGCConcurrentMark(KBoolean value) {
+  GC_LOG("setGCConcurrentMark %d\n", value)
+  memoryState->gcConcurrentMark = value;
+}
+
+KBoolean getGCConcurrentMark() {
+  GC_LOG("getGCConcurrentMark\n")
+  return memoryState->gcConcurrentMark;
+}
+#endif  // USE_CONCURRENT_MARK
+
+#if USE_GC_HELPERS
+void setGCHelperThreads(KInt value) {
+  GC_LOG("setGCHelperThreads %d\n", value)
+  if (value < 0 || value > kMaxGcHelpers) {
+    ThrowIllegalArgumentException();
+  }
+  memoryState->gcHelperCount = value;
+}
+
+KInt getGCHelperThreads() {
+  GC_LOG("getGCHelperThreads\n")
+  return memoryState->gcHelperCount;
+}
+#endif  // USE_GC_HELPERS
+
+#if USE_GC
+
+struct StablePointerRecord {
+  // Worker which created the stable pointers, owning the object unless it is shareable.
+  MemoryState* owner;
+  int count;
+};
+
+// Objects with stable pointers, reported as roots in heap dumps. Only tracked while enabled with
+// GC.stablePointerRoots, as it costs a global lock on creation and disposal of every stable pointer.
+// Guarded by stablePointersLock, as stable pointers could be disposed by any thread.
+KStdUnorderedMap<KRef, KStdVector<StablePointerRecord>>* stablePointers = nullptr;
+KInt stablePointersLock = 0;
+KBoolean stablePointersTracked = false;
+// Number of tracked stable pointers, so that disposal only takes the lock if there are any.
+KInt stablePointersCount = 0;
+
+void registerStablePointer(KRef object) {
+  if (!atomicGet(&stablePointersTracked)) return;
+  lock(&stablePointersLock);
+  if (stablePointers == nullptr)
+    stablePointers = konanConstructInstance<KStdUnorderedMap<KRef, KStdVector<StablePointerRecord>>>();
+  auto& records = (*stablePointers)[object];
+  auto it = std::find_if(records.begin(), records.end(), [](const StablePointerRecord& record) {
+    return record.owner == memoryState;
+  });
+  if (it == records.end()) {
+    records.push_back({memoryState, 1});
+  } else {
+    it->count++;
+  }
+  atomicAdd(&stablePointersCount, 1);
+  unlock(&stablePointersLock);
+}
+
+void unregisterStablePointer(KRef object) {
+  if (atomicGet(&stablePointersCount) == 0) return;
+  lock(&stablePointersLock);
+  // Stable pointers created before tracking was enabled are not known.
+  auto found = stablePointers->find(object);
+  if (found != stablePointers->end()) {
+    auto& records = found->second;
+    // Disposed by another worker, if the object was transferred, so any owner would do then.
+    auto it = std::find_if(records.begin(), records.end(), [](const StablePointerRecord& record) {
+      return record.owner == memoryState;
+    });
+    if (it == records.end()) it = records.begin();
+    if (--it->count == 0) records.erase(it);
+    if (records.empty()) stablePointers->erase(found);
+    atomicAdd(&stablePointersCount, -1);
+  }
+  unlock(&stablePointersLock);
+}
+
+// Called when the worker exits, so that a new worker getting the same state address does not own its objects.
+void forgetStablePointers(MemoryState* state) {
+  if (atomicGet(&stablePointersCount) == 0) return;
+  lock(&stablePointersLock);
+  for (auto& it : *stablePointers) {
+    for (auto& record : it.second) {
+      if (record.owner == state) record.owner = nullptr;
+    }
+  }
+  unlock(&stablePointersLock);
+}
+
+enum HeapRootKind {
+  kHeapRootStack = 1,
+  kHeapRootGlobal,
+  kHeapRootThreadLocal,
+  kHeapRootStablePointer
+};
+
+/**
+ * Writes objects reachable from the roots of the current worker in a compact binary form, which is
+ * converted to a report by tools/heapdump/heapReport.py. All numbers are little-endian.
+ *   header:  "KNHEAP01"
+ *   type:    'T' u32:id u32:length utf8:name
+ *   root:    'R' u8:kind u64:address
+ *   object:  'O' u64:address u32:typeId u32:size u32:edgeCount u64[edgeCount]:address
+ *   end:     'E'
+ * Types are written before the first object of that type, roots before any object.
+ */
+class HeapDumper {
+ public:
+  explicit HeapDumper(FILE* file) : file_(file) {}
+
+  void addRoot(HeapRootKind kind, ObjHeader* object) {
+    if (object == nullptr) return;
+    roots_.push_back(std::make_pair(kind, object));
+  }
+
+  bool dump() {
+    write("KNHEAP01", 8);
+    for (auto& root : roots_) {
+      writeU8('R');
+      writeU8(root.first);
+      writeU64(reinterpret_cast<uintptr_t>(root.second));
+      visit(root.second);
+    }
+    while (!toVisit_.empty()) {
+      ObjHeader* obj = toVisit_.back();
+      toVisit_.pop_back();
+      dumpObject(obj);
+    }
+    writeU8('E');
+    return ferror(file_) == 0;
+  }
+
+ private:
+  FILE* file_;
+  KStdVector<std::pair<HeapRootKind, ObjHeader*>> roots_;
+  KStdUnorderedSet<ObjHeader*> visited_;
+  KStdVector<ObjHeader*> toVisit_;
+  KStdVector<ObjHeader*> edges_;
+  KStdUnorderedMap<const TypeInfo*, uint32_t> typeIds_;
+
+  void visit(ObjHeader* obj) {
+    if (visited_.insert(obj).second)
+      toVisit_.push_back(obj);
+  }
+
+  void dumpObject(ObjHeader* obj) {
+    uint32_t typeId = typeIdOf(obj->type_info());
+    edges_.clear();
+    traverseReferredObjects(obj, [this](ObjHeader* ref) {
+      edges_.push_back(ref);
+    });
+    writeU8('O');
+    writeU64(reinterpret_cast<uintptr_t>(obj));
+    writeU32(typeId);
+    writeU32(objectSize(obj));
+    writeU32(edges_.size());
+    for (auto* ref : edges_) {
+      writeU64(reinterpret_cast<uintptr_t>(ref));
+      visit(ref);
+    }
+  }
+
+  uint32_t typeIdOf(const TypeInfo* typeInfo) {
+    auto it = typeIds_.find(typeInfo);
+    if (it != typeIds_.end()) return it->second;
+    uint32_t id = typeIds_.size();
+    typeIds_.emplace(typeInfo, id);
+    char* packageName = CreateCStringFromString(typeInfo->packageName_);
+    char* relativeName = CreateCStringFromString(typeInfo->relativeName_);
+    KStdString name;
+    if (packageName != nullptr && packageName[0] != '\0') {
+      name += packageName;
+      name += '.';
+    }
+    name += relativeName != nullptr ? relativeName : "<anonymous>";
+    DisposeCString(packageName);
+    DisposeCString(relativeName);
+    writeU8('T');
+    writeU32(id);
+    writeU32(name.size());
+    write(name.data(), name.size());
+    return id;
+  }
+
+  void write(const void* data, size_t size) {
+    fwrite(data, 1, size, file_);
+  }
+
+  void writeU8(uint8_t value) {
+    write(&value, sizeof(value));
+  }
+
+  void writeU32(uint32_t value) {
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++) bytes[i] = value >> (i * 8);
+    write(bytes, sizeof(bytes));
+  }
+
+  void writeU64(uint64_t value) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = value >> (i * 8);
+    write(bytes, sizeof(bytes));
+  }
+};
+
+void addStackRoots(HeapDumper* dumper) {
+  FrameOverlay* frame = currentFrame;
+  while (frame != nullptr) {
+    ObjHeader** current = reinterpret_cast<ObjHeader**>(frame + 1) + frame->parameters;
+    ObjHeader** end = current + frame->count - kFrameOverlaySlots - frame->parameters;
+    while (current < end)
+      dumper->addRoot(kHeapRootStack, *current++);
+    frame = frame->previous;
+  }
+}
+
+void addStablePointerRoots(MemoryState* state, HeapDumper* dumper) {
+  lock(&stablePointersLock);
+  if (stablePointers != nullptr) {
+    for (auto& it : *stablePointers) {
+      // Objects of other workers are not safe to traverse.
+      bool owned = std::any_of(it.second.begin(), it.second.end(), [state](const StablePointerRecord& record) {
+        return record.owner == state;
+      });
+      if (owned || isShareable(it.first->container()))
+        dumper->addRoot(kHeapRootStablePointer, it.first);
+    }
+  }
+  unlock(&stablePointersLock);
+}
+
+bool dumpHeap(MemoryState* state, const char* path) {
+  FILE* file = fopen(path, "wb");
+  if (file == nullptr) return false;
+  HeapDumper dumper(file);
+  addStackRoots(&dumper);
+  state->heapDumper = &dumper;
+  Kotlin_visitGlobalRoots(state);
+  state->heapDumper = nullptr;
+  for (auto& it : *state->tlsMap) {
+    KRef* start = it.second.first;
+    for (int index = 0; index < it.second.second; index++)
+      dumper.addRoot(kHeapRootThreadLocal, start[index]);
+  }
+  addStablePointerRoots(state, &dumper);
+  bool result = dumper.dump();
+  return fclose(file) == 0 && result;
+}
+
+#endif  // USE_GC
+
+KNativePtr createStablePointer(KRef any) {
+  if (any == nullptr) return nullptr;
+  MEMORY_LOG("CreateStablePointer for %p rc=%d\n", any, any->container() ? any->container()->refCount() : 0)
+  addHeapRef(any);
+#if USE_GC
+  registerStablePointer(any);
+#endif  // USE_GC
+  return reinterpret_cast<KNativePtr>(any);
+}
+
+void disposeStablePointer(KNativePtr pointer) {
+  if (pointer == nullptr) return;
+  KRef ref = reinterpret_cast<KRef>(pointer);
+#if USE_GC
+  unregisterStablePointer(ref);
+#endif  // USE_GC
+  ReleaseHeapRef(ref);
+}
+
+OBJ_GETTER(derefStablePointer, KNativePtr pointer) {
+  KRef ref = reinterpret_cast<KRef>(pointer);
+  AdoptReferenceFromSharedVariable(ref);
+  RETURN_OBJ(ref);
+}
+
+OBJ_GETTER(adoptStablePointer, KNativePtr pointer) {
+  synchronize();
+  KRef ref = reinterpret_cast<KRef>(pointer);
+  MEMORY_LOG("adopting stable pointer %p, rc=%d\n", \
      ref, (ref && ref->container()) ? ref->container()->refCount() : -1)
   UpdateReturnRef(OBJ_RESULT, ref);
   DisposeStablePointer(pointer);
@@ -2390,6 +4411,7 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
 #if USE_GC
   MEMORY_LOG("ClearSubgraphReferences %p\n", root)
   if (root == nullptr) return true;
+  GCTraceScope traceScope("clearSubgraphReferences");
   auto state = memoryState;
   auto* container = root->container();
 
@@ -2399,14 +4421,18 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
     // TODO: assert for that?
     return true;
 
+#if USE_CONCURRENT_MARK
+  // Containers are about to leave this worker, so marker thread shall no longer look at them.
+  abortConcurrentMark(state);
+#endif  // USE_CONCURRENT_MARK
+
   ContainerHeaderSet visited;
   if (!checked) {
     hasExternalRefs(container, &visited);
   } else {
     // Now decrement RC of elements in toRelease set for reachibility analysis.
-    for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
-      auto released = *it;
-      if (!isMarkedAsRemoved(released) && released->local()) {
+    for (auto* released : *(state->toRelease)) {
+      if (released->local()) {
         released->decRefCount<false>();
       }
     }
@@ -2416,11 +4442,10 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
     scanBlack<false>(container);
     // Restore original RC.
     container->incRefCount<false>();
-    for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
-       auto released = *it;
-       if (!isMarkedAsRemoved(released) && released->local()) {
-         released->incRefCount<false>();
-       }
+    for (auto* released : *(state->toRelease)) {
+      if (released->local()) {
+        released->incRefCount<false>();
+      }
     }
     if (bad) {
       return false;
@@ -2428,29 +4453,99 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
   }
 
   // Remove all no longer owned containers from GC structures.
-  // TODO: not very efficient traversal.
-  for (auto it = state->toFree->begin(); it != state->toFree->end(); ++it) {
-    auto container = *it;
-    if (visited.count(container) != 0) {
+  state->toFree->removeIf([&visited](ContainerHeader* container) {
+    if (visited.count(container) == 0) return false;
+    MEMORY_LOG("removing %p from the toFree list\n", container)
+    container->resetBuffered();
+    container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
+    return true;
+  });
+  state->toRelease->removeIf([&visited](ContainerHeader* container) {
+    if (visited.count(container) == 0) return false;
+    MEMORY_LOG("removing %p from the toRelease list\n", container)
+    container->decRefCount<false>();
+    return true;
+  });
+
+#if TRACE_MEMORY
+  // Forget transferred containers.
+  for (auto* it: visited) {
+    state->containers->erase(it);
+  }
+#endif
+
+#endif  // USE_GC
+  return true;
+}
+
+// Fast path of clearSubgraphReferences(root, true) for the subgraphs nobody else has seen yet, such as
+// just built by a producer function: if reference count of every container is exactly the number of references
+// from within the subgraph plus its deferred releases, there are no external references, so the trial decrement
+// with markGray/scanBlack is not needed. Freshly allocated containers always have a deferred release, see
+// rememberFreshContainer(). Returns false, leaving the subgraph intact, otherwise.
+// Note that root is expected to be held by a stable pointer, as in transfer.
+bool clearFreshSubgraphReferences(ObjHeader* root) {
+#if USE_GC
+  MEMORY_LOG("ClearFreshSubgraphReferences %p\n", root)
+  if (root == nullptr) return true;
+  auto* container = root->container();
+  if (isShareable(container)) return true;
+
+  KStdUnorderedMap<ContainerHeader*, int> references;
+  references[container] = 1;
+  ContainerHeaderDeque toVisit;
+  toVisit.push_back(container);
+  bool buffered = false;
+  while (!toVisit.empty()) {
+    auto* current = toVisit.front();
+    toVisit.pop_front();
+    if (!current->local()) return false;
+    // Collection during construction of the subgraph may have made its containers cycle candidates.
+    buffered |= current->buffered();
+    traverseContainerReferredObjects(current, [&toVisit, &references](ObjHeader* ref) {
+      auto* child = ref->container();
+      if (isShareable(child)) return;
+      if (references[child]++ == 0) toVisit.push_back(child);
+    });
+  }
+  // Same as the trial decrement of the checked path.
+  for (auto* released : *(memoryState->toRelease)) {
+    auto it = references.find(released);
+    if (it != references.end()) it->second++;
+  }
+  for (auto& it : references) {
+    if (it.first->refCount() != it.second) {
+      MEMORY_LOG("container %p with rc %d is not fresh\n", it.first, it.first->refCount())
+      return false;
+    }
+  }
+
+#if USE_CONCURRENT_MARK
+  // Containers are about to leave this worker, so marker thread shall no longer look at them.
+  abortConcurrentMark(memoryState);
+#endif  // USE_CONCURRENT_MARK
+
+  if (buffered) {
+    memoryState->toFree->removeIf([&references](ContainerHeader* container) {
+      if (references.count(container) == 0) return false;
       MEMORY_LOG("removing %p from the toFree list\n", container)
       container->resetBuffered();
       container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
-      *it = markAsRemoved(container);
-    }
-  }
-  for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
-    auto container = *it;
-    if (!isMarkedAsRemoved(container) && visited.count(container) != 0) {
-      MEMORY_LOG("removing %p from the toRelease list\n", container)
-      container->decRefCount<false>();
-      *it = markAsRemoved(container);
-    }
+      return true;
+    });
   }
+  memoryState->toRelease->removeIf([&references](ContainerHeader* container) {
+    if (references.count(container) == 0) return false;
+    MEMORY_LOG("removing %p from the toRelease list\n", container)
+    container->decRefCount<false>();
+    return true;
+  });
+  memoryState->gcStatistics.freshTransfers++;
 
 #if TRACE_MEMORY
   // Forget transferred containers.
-  for (auto* it: visited) {
-    state->containers->erase(it);
+  for (auto& it : references) {
+    memoryState->containers->erase(it.first);
   }
 #endif
 
@@ -2593,6 +4688,7 @@ void freezeCyclic(ObjHeader* root,
  */
 void freezeSubgraph(ObjHeader* root) {
   if (root == nullptr) return;
+  GCTraceScope traceScope("freeze");
   // First check that passed object graph has no cycles.
   // If there are cycles - run graph condensation on cyclic graphs using Kosoraju-Sharir.
   ContainerHeader* rootContainer = root->container();
@@ -2600,6 +4696,12 @@ void freezeSubgraph(ObjHeader* root) {
 
   MEMORY_LOG("Freeze subgraph of %p\n", root)
 
+#if USE_CONCURRENT_MARK
+  // Frozen containers could be released by other workers, so marker thread shall no longer look at them.
+  if (memoryState != nullptr)
+    abortConcurrentMark(memoryState);
+#endif  // USE_CONCURRENT_MARK
+
   // Do DFS cycle detection.
   bool hasCycles = false;
   KRef firstBlocker = root->has_meta_object() && ((root->meta_object()->flags_ & MF_NEVER_FROZEN) != 0) ?
@@ -2624,12 +4726,11 @@ void freezeSubgraph(ObjHeader* root) {
   // TODO: optimize it by keeping ignored (i.e. freshly frozen) objects in the set,
   // and use it when analyzing toFree during collection.
   auto state = memoryState;
-  for (auto& container : *(state->toFree)) {
-    if (!isMarkedAsRemoved(container) && container->frozen()) {
-      RuntimeAssert(newlyFrozen.count(container) != 0, "Must be newly frozen");
-      container = markAsRemoved(container);
-    }
-  }
+  state->toFree->removeIf([&newlyFrozen](ContainerHeader* container) {
+    if (!container->frozen()) return false;
+    RuntimeAssert(newlyFrozen.count(container) != 0, "Must be newly frozen");
+    return true;
+  });
 #endif
 }
 
@@ -2646,6 +4747,9 @@ void shareAny(ObjHeader* obj) {
   auto* container = obj->container();
   if (isShareable(container)) return;
   RuntimeCheck(container->objectCount() == 1, "Must be a single object container");
+#if USE_CONCURRENT_MARK
+  abortConcurrentMark(memoryState);
+#endif  // USE_CONCURRENT_MARK
   container->makeShared();
 }
 
@@ -2695,7 +4799,8 @@ void ObjHeader::destroyMetaObject(TypeInfo** location) {
 void ObjectContainer::Init(MemoryState* state, const TypeInfo* typeInfo) {
   RuntimeAssert(typeInfo->instanceSize_ >= 0, "Must be an object");
   uint32_t allocSize = sizeof(ContainerHeader) + typeInfo->instanceSize_;
-  header_ = allocContainer(state, allocSize);
+  header_ = allocObjectContainer(state, allocSize);
+  // Object allocations are emitted without an exception handler, see RUNTIME_NOTHROW of AllocInstance.
   RuntimeCheck(header_ != nullptr, "Cannot alloc memory");
   // One object in this container, no need to set.
   header_->setContainerSize(allocSize);
@@ -2709,8 +4814,12 @@ void ArrayContainer::Init(MemoryState* state, const TypeInfo* typeInfo, uint32_t
   RuntimeAssert(typeInfo->instanceSize_ < 0, "Must be an array");
   uint32_t allocSize =
       sizeof(ContainerHeader) + arrayObjectSize(typeInfo, elements);
-  header_ = allocContainer(state, allocSize);
-  RuntimeCheck(header_ != nullptr, "Cannot alloc memory");
+  header_ = allocObjectContainer(state, allocSize);
+#if USE_GC
+  if (header_ == nullptr) throwOutOfMemoryError(state);
+#else
+  if (header_ == nullptr) ThrowOutOfMemoryError();
+#endif  // USE_GC
   // One object in this container, no need to set.
   header_->setContainerSize(allocSize);
   RuntimeAssert(header_->objectCount() == 1, "Must work properly");
@@ -2747,7 +4856,7 @@ bool ArenaContainer::allocContainer(container_size_t minSize) {
   auto size = minSize + sizeof(ContainerHeader) + sizeof(ContainerChunk);
   size = alignUp(size, kContainerAlignment);
   // TODO: keep simple cache of container chunks.
-  ContainerChunk* result = konanConstructSizedInstance<ContainerChunk>(size);
+  ContainerChunk* result = reinterpret_cast<ContainerChunk*>(allocOwnedMemory(memoryState, size));
   RuntimeCheck(result != nullptr, "Cannot alloc memory");
   if (result == nullptr) return false;
   result->next = currentChunk_;
@@ -2852,8 +4961,8 @@ void AdoptReferenceFromSharedVariable(ObjHeader* object) {
 }
 
 // Public memory interface.
-MemoryState* InitMemory() {
-  return initMemory();
+MemoryState* InitMemory(bool threadBound) {
+  return initMemory(threadBound);
 }
 
 void DeinitMemory(MemoryState* memoryState) {
@@ -2868,6 +4977,17 @@ void ResumeMemory(MemoryState* state) {
   resumeMemory(state);
 }
 
+void StopGcThreads() {
+#if USE_CONCURRENT_MARK
+  auto* state = memoryState;
+  if (state == nullptr || state->concurrentMarker == nullptr) return;
+  // Candidates of the mark in flight are returned to the list, and processed by the next collection.
+  abortConcurrentMark(state);
+  konanDestructInstance(state->concurrentMarker);
+  state->concurrentMarker = nullptr;
+#endif  // USE_CONCURRENT_MARK
+}
+
 OBJ_GETTER(AllocInstanceStrict, const TypeInfo* type_info) {
   RETURN_RESULT_OF(allocInstance<true>, type_info);
 }
@@ -2882,6 +5002,10 @@ OBJ_GETTER(AllocArrayInstanceRelaxed, const TypeInfo* typeInfo, int32_t elements
   RETURN_RESULT_OF(allocArrayInstance<false>, typeInfo, elements);
 }
 
+bool TryGrowArrayInPlace(ArrayHeader* array, int32_t newCount) {
+  return tryGrowArrayInPlace(array, newCount);
+}
+
 OBJ_GETTER(InitInstanceStrict,
     ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*)) {
   RETURN_RESULT_OF(initInstance<true>, location, typeInfo, ctor);
@@ -2983,6 +5107,7 @@ void LeaveFrameRelaxed(ObjHeader** start, int parameters, int count) {
 
 void Kotlin_native_internal_GC_collect(KRef) {
 #if USE_GC
+  raisePendingHeapLimits(memoryState);
   garbageCollect();
 #endif
 }
@@ -3062,6 +5187,176 @@ KLong Kotlin_native_internal_GC_getThresholdAllocations(KRef) {
 #endif
 }
 
+void Kotlin_native_internal_GC_setMaxPauseMicros(KRef, KLong value) {
+#if USE_GC
+  setGCMaxPauseMicros(value);
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getMaxPauseMicros(KRef) {
+#if USE_GC
+  return getGCMaxPauseMicros();
+#else
+  return -1;
+#endif
+}
+
+void Kotlin_native_internal_GC_setTargetOverhead(KRef, KDouble value) {
+#if USE_GC
+  setGCTargetOverhead(value);
+#endif
+}
+
+KDouble Kotlin_native_internal_GC_getTargetOverhead(KRef) {
+#if USE_GC
+  return getGCTargetOverhead();
+#else
+  return -1;
+#endif
+}
+
+void Kotlin_native_internal_GC_setTargetHeapBytes(KRef, KLong value) {
+#if USE_GC
+  setGCTargetHeapBytes(value);
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getTargetHeapBytes(KRef) {
+#if USE_GC
+  return getGCTargetHeapBytes();
+#else
+  return -1;
+#endif
+}
+
+void Kotlin_native_internal_GC_setSoftHeapLimit(KRef, KLong value) {
+#if USE_GC
+  setGCSoftHeapLimit(value);
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getSoftHeapLimit(KRef) {
+#if USE_GC
+  return getGCSoftHeapLimit();
+#else
+  return -1;
+#endif
+}
+
+void Kotlin_native_internal_GC_setHardHeapLimit(KRef, KLong value) {
+#if USE_GC
+  setGCHardHeapLimit(value);
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getHardHeapLimit(KRef) {
+#if USE_GC
+  return getGCHardHeapLimit();
+#else
+  return -1;
+#endif
+}
+
+KLong Kotlin_native_internal_GC_trimHeap(KRef) {
+#if USE_GC
+  auto* state = memoryState;
+  auto lastTrimTimestamp = state->lastTrimTimestamp;
+  garbageCollect(state, true);
+  // Collection could have trimmed the heap automatically already.
+  if (state->lastTrimTimestamp != lastTrimTimestamp) return state->lastTrimBytes;
+  return trimHeap(state);
+#else
+  return 0;
+#endif
+}
+
+void Kotlin_native_internal_GC_setAutoTrim(KRef, KBoolean value) {
+#if USE_GC
+  setGCAutoTrim(value);
+#endif
+}
+
+KBoolean Kotlin_native_internal_GC_getAutoTrim(KRef) {
+#if USE_GC
+  return getGCAutoTrim();
+#else
+  return false;
+#endif
+}
+
+void Kotlin_native_internal_GC_getStatistics(KRef, KRef values) {
+#if USE_GC
+  getGCStatistics(values);
+#endif
+}
+
+void Kotlin_native_internal_GC_dumpHeap(KRef, KRef path) {
+#if USE_GC
+  char* cpath = CreateCStringFromString(path);
+  bool result = dumpHeap(memoryState, cpath);
+  DisposeCString(cpath);
+  if (!result) ThrowIllegalArgumentException();
+#else
+  ThrowIllegalStateException();
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getHeapBytes(KRef) {
+#if USE_GC
+  return getGCHeapBytes();
+#else
+  return -1;
+#endif
+}
+
+KBoolean Kotlin_native_internal_GC_getStablePointerRoots(KRef) {
+#if USE_GC
+  return atomicGet(&stablePointersTracked);
+#else
+  return false;
+#endif  // USE_GC
+}
+
+void Kotlin_native_internal_GC_setStablePointerRoots(KRef, KBoolean value) {
+#if USE_GC
+  atomicSet(&stablePointersTracked, value);
+#endif  // USE_GC
+}
+
+KBoolean Kotlin_native_internal_GC_getConcurrentMark(KRef) {
+#if USE_CONCURRENT_MARK
+  return getGCConcurrentMark();
+#else
+  return false;
+#endif  // USE_CONCURRENT_MARK
+}
+
+void Kotlin_native_internal_GC_setConcurrentMark(KRef, KBoolean value) {
+#if USE_CONCURRENT_MARK
+  setGCConcurrentMark(value);
+#else
+  if (value)
+    ThrowIllegalArgumentException();
+#endif  // USE_CONCURRENT_MARK
+}
+
+KInt Kotlin_native_internal_GC_getHelperThreads(KRef) {
+#if USE_GC_HELPERS
+  return getGCHelperThreads();
+#else
+  return 0;
+#endif  // USE_GC_HELPERS
+}
+
+void Kotlin_native_internal_GC_setHelperThreads(KRef, KInt value) {
+#if USE_GC_HELPERS
+  setGCHelperThreads(value);
+#else
+  if (value != 0)
+    ThrowIllegalArgumentException();
+#endif  // USE_GC_HELPERS
+}
+
 void Kotlin_native_internal_GC_setTuneThreshold(KRef, KInt value) {
 #if USE_GC
   setTuneGCThreshold(value);
@@ -3096,6 +5391,10 @@ bool ClearSubgraphReferences(ObjHeader* root, bool checked) {
   return clearSubgraphReferences(root, checked);
 }
 
+bool ClearFreshSubgraphReferences(ObjHeader* root) {
+  return clearFreshSubgraphReferences(root);
+}
+
 void FreezeSubgraph(ObjHeader* root) {
   freezeSubgraph(root);
 }
@@ -3116,6 +5415,16 @@ void Kotlin_Any_share(ObjHeader* obj) {
   shareAny(obj);
 }
 
+void VisitGlobalRoot(MemoryState* memory, ObjHeader** location) {
+#if USE_GC
+  ObjHeader* object = *location;
+  // Globals which are not shareable are only accessible from the main thread.
+  if (memory->heapDumper != nullptr && object != nullptr &&
+      (isShareable(object->container()) || Kotlin_isMainThread()))
+    memory->heapDumper->addRoot(kHeapRootGlobal, object);
+#endif  // USE_GC
+}
+
 void AddTLSRecord(MemoryState* memory, void** key, int size) {
   auto* tlsMap = memory->tlsMap;
   auto it = tlsMap->find(key);
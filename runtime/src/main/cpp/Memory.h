@@ -68,7 +68,12 @@ typedef enum {
   CONTAINER_TAG_GC_BUFFERED = 1 << (CONTAINER_TAG_COLOR_SHIFT + 1),
   CONTAINER_TAG_GC_SEEN     = 1 << (CONTAINER_TAG_COLOR_SHIFT + 2),
   // If indeed has more that one object.
-  CONTAINER_TAG_GC_HAS_OBJECT_COUNT = 1 << (CONTAINER_TAG_COLOR_SHIFT + 3)
+  CONTAINER_TAG_GC_HAS_OBJECT_COUNT = 1 << (CONTAINER_TAG_COLOR_SHIFT + 3),
+  // Single object container allocated in the nursery chunk, see allocNurseryContainer().
+  // Takes the upper bit of the container size.
+  CONTAINER_TAG_GC_NURSERY = 1 << 30,
+  // Maximal container size we could record, bigger containers are recorded with this size.
+  CONTAINER_TAG_GC_MAX_SIZE = (CONTAINER_TAG_GC_NURSERY >> CONTAINER_TAG_GC_SHIFT) - 1
 } ContainerTag;
 
 typedef enum {
@@ -193,6 +198,21 @@ struct ContainerHeader {
         (objectCount_ >> CONTAINER_TAG_GC_SHIFT) : 1;
   }
 
+  // Same as refCount(), shareable() and objectCount(), but could be used by a thread other than the owner,
+  // while the owner updates the header. Result may be stale.
+  inline int refCountRelaxed() const {
+    return (int)__atomic_load_n(&refCount_, __ATOMIC_RELAXED) >> CONTAINER_TAG_SHIFT;
+  }
+
+  inline bool shareableRelaxed() const {
+    return (__atomic_load_n(&refCount_, __ATOMIC_RELAXED) & 1) != 0;
+  }
+
+  inline unsigned objectCountRelaxed() const {
+    uint32_t objectCount = __atomic_load_n(&objectCount_, __ATOMIC_RELAXED);
+    return (objectCount & CONTAINER_TAG_GC_HAS_OBJECT_COUNT) != 0 ? (objectCount >> CONTAINER_TAG_GC_SHIFT) : 1;
+  }
+
   inline void incObjectCount() {
     RuntimeAssert((objectCount_ & CONTAINER_TAG_GC_HAS_OBJECT_COUNT) != 0, "Must have object count");
     objectCount_ += CONTAINER_TAG_GC_INCREMENT;
@@ -208,12 +228,23 @@ struct ContainerHeader {
 
   inline unsigned containerSize() const {
     RuntimeAssert((objectCount_ & CONTAINER_TAG_GC_HAS_OBJECT_COUNT) == 0, "Must be single-object");
-    return (objectCount_ >> CONTAINER_TAG_GC_SHIFT);
+    return (objectCount_ & ~CONTAINER_TAG_GC_NURSERY) >> CONTAINER_TAG_GC_SHIFT;
   }
 
   inline void setContainerSize(unsigned size) {
     RuntimeAssert((objectCount_ & CONTAINER_TAG_GC_HAS_OBJECT_COUNT) == 0, "Must not have object count");
-    objectCount_ = (objectCount_ & CONTAINER_TAG_GC_MASK) | (size << CONTAINER_TAG_GC_SHIFT);
+    if (size > CONTAINER_TAG_GC_MAX_SIZE) size = CONTAINER_TAG_GC_MAX_SIZE;
+    objectCount_ = (objectCount_ & (CONTAINER_TAG_GC_MASK | CONTAINER_TAG_GC_NURSERY)) |
+        (size << CONTAINER_TAG_GC_SHIFT);
+  }
+
+  inline bool nursery() const {
+    return (objectCount_ & (CONTAINER_TAG_GC_HAS_OBJECT_COUNT | CONTAINER_TAG_GC_NURSERY)) == CONTAINER_TAG_GC_NURSERY;
+  }
+
+  inline void setNursery() {
+    RuntimeAssert((objectCount_ & CONTAINER_TAG_GC_HAS_OBJECT_COUNT) == 0, "Must be single-object");
+    objectCount_ |= CONTAINER_TAG_GC_NURSERY;
   }
 
   inline bool hasContainerSize() {
@@ -364,6 +395,22 @@ struct ObjHeader {
     return (reinterpret_cast<MetaObjHeader*>(clearPointerBits(typeInfoOrMeta_, OBJECT_TAG_MASK)))->container_;
   }
 
+  // Same as type_info() and container(), but could be used by a thread other than the owner,
+  // while the owner creates the meta object.
+  const TypeInfo* typeInfoRelaxed() const {
+    return clearPointerBits(__atomic_load_n(&typeInfoOrMeta_, __ATOMIC_RELAXED), OBJECT_TAG_MASK)->typeInfo_;
+  }
+
+  ContainerHeader* containerRelaxed() const {
+    auto* typeInfoOrMeta = __atomic_load_n(&typeInfoOrMeta_, __ATOMIC_RELAXED);
+    unsigned bits = getPointerBits(typeInfoOrMeta, OBJECT_TAG_MASK);
+    if ((bits & (OBJECT_TAG_PERMANENT_CONTAINER | OBJECT_TAG_NONTRIVIAL_CONTAINER)) == 0)
+      return reinterpret_cast<ContainerHeader*>(const_cast<ObjHeader*>(this)) - 1;
+    if ((bits & OBJECT_TAG_PERMANENT_CONTAINER) != 0)
+      return nullptr;
+    return (reinterpret_cast<MetaObjHeader*>(clearPointerBits(typeInfoOrMeta, OBJECT_TAG_MASK)))->container_;
+  }
+
   inline bool local() const {
     unsigned bits = getPointerBits(typeInfoOrMeta_, OBJECT_TAG_MASK);
     return (bits & (OBJECT_TAG_PERMANENT_CONTAINER | OBJECT_TAG_NONTRIVIAL_CONTAINER)) ==
@@ -427,11 +474,15 @@ extern "C" {
 
 struct MemoryState;
 
-MemoryState* InitMemory();
+// If threadBound, memory state is never used by another thread unless suspended, and allocates in its own heap.
+MemoryState* InitMemory(bool threadBound);
 void DeinitMemory(MemoryState*);
 
 MemoryState* SuspendMemory();
 void ResumeMemory(MemoryState* state);
+// Stops GC threads serving the current thread, once it no longer runs Kotlin code, e.g. when the worker terminates.
+// They are started again on demand.
+void StopGcThreads();
 
 //
 // Object allocation.
@@ -453,6 +504,10 @@ OBJ_GETTER(AllocArrayInstanceStrict, const TypeInfo* type_info, int32_t elements
 OBJ_GETTER(AllocArrayInstanceRelaxed, const TypeInfo* type_info, int32_t elements);
 OBJ_GETTER(AllocArrayInstance, const TypeInfo* type_info, int32_t elements);
 
+// Grows the array to newCount zeroed elements without moving it, false if it is not possible.
+// Only safe for arrays not observed by any other code, as it changes the size of existing object.
+bool TryGrowArrayInPlace(ArrayHeader* array, int32_t newCount);
+
 OBJ_GETTER(InitInstanceStrict,
     ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*));
 OBJ_GETTER(InitInstanceRelaxed,
@@ -529,6 +584,9 @@ MODEL_VARIANTS(void, LeaveFrame, ObjHeader** start, int parameters, int count);
 // checks if subgraph referenced by given root is disjoint from the rest of
 // object graph, i.e. no external references exists.
 bool ClearSubgraphReferences(ObjHeader* root, bool checked) RUNTIME_NOTHROW;
+// Same as checked ClearSubgraphReferences(), but only succeeds if the subgraph is fresh, i.e. its reference counts
+// show no references but the internal ones, which is much cheaper to check. Does nothing if it returns false.
+bool ClearFreshSubgraphReferences(ObjHeader* root) RUNTIME_NOTHROW;
 // Creates stable pointer out of the object.
 void* CreateStablePointer(ObjHeader* obj) RUNTIME_NOTHROW;
 // Disposes stable pointer to the object.
@@ -543,6 +601,8 @@ void MutationCheck(ObjHeader* obj);
 void FreezeSubgraph(ObjHeader* obj);
 // Ensure this object shall block freezing.
 void EnsureNeverFrozen(ObjHeader* obj);
+// Report global variable as a root to the heap dump in progress, called by the generated code.
+void VisitGlobalRoot(MemoryState* memory, ObjHeader** location) RUNTIME_NOTHROW;
 // Add TLS object storage, called by the generated code.
 void AddTLSRecord(MemoryState* memory, void** key, int size) RUNTIME_NOTHROW;
 // Clear TLS object storage, called by the generated code.
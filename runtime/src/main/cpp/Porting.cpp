@@ -24,10 +24,13 @@
 #include <string.h>
 #if !KONAN_NO_THREADS
 #include <pthread.h>
+#include <sched.h>
 #endif
 #include <unistd.h>
 #if KONAN_WINDOWS
 #include <windows.h>
+#elif !KONAN_WASM && !KONAN_ZEPHYR
+#include <sys/mman.h>
 #endif
 
 #include <chrono>
@@ -234,6 +237,22 @@ void onThreadExit(void (*destructor)(void*), void* destructorParameter) {
 #endif  // !KONAN_NO_THREADS
 }
 
+void spinPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+void yieldThread() {
+#if KONAN_WINDOWS
+  ::SwitchToThread();
+#elif !KONAN_NO_THREADS
+  ::sched_yield();
+#endif
+}
+
 // Process execution.
 void abort(void) {
   ::abort();
@@ -281,10 +300,26 @@ size_t strnlen(const char* buffer, size_t maxSize) {
 // Memory operations.
 #if KONAN_INTERNAL_DLMALLOC
 extern "C" void* dlcalloc(size_t, size_t);
+extern "C" void* dlmemalign(size_t, size_t);
 extern "C" void dlfree(void*);
+extern "C" int dlmalloc_trim(size_t);
+
+void* dlcalloc_aligned(size_t count, size_t size, size_t alignment) {
+  size_t total = count * size;
+  if (size != 0 && total / size != count) return nullptr;
+  void* result = dlmemalign(alignment, total);
+  if (result != nullptr) memset(result, 0, total);
+  return result;
+}
+
 #define calloc_impl dlcalloc
 #define free_impl dlfree
-#define calloc_aligned_impl(count, size, alignment) dlcalloc(count, size)
+#define calloc_aligned_impl dlcalloc_aligned
+#define heap_create_impl() nullptr
+#define heap_destroy_impl(heap)
+#define heap_calloc_impl(heap, count, size) dlcalloc(count, size)
+#define heap_calloc_aligned_impl(heap, count, size, alignment) dlcalloc_aligned(count, size, alignment)
+#define heap_trim_impl(heap) dlmalloc_trim(0)
 
 #else
 extern "C" void* konan_calloc_impl(size_t, size_t);
@@ -292,7 +327,17 @@ extern "C" void konan_free_impl(void*);
 extern "C" void* konan_calloc_aligned_impl(size_t count, size_t size, size_t alignment);
 #define calloc_impl konan_calloc_impl
 #define free_impl konan_free_impl
+extern "C" void* konan_heap_create_impl();
+extern "C" void konan_heap_destroy_impl(void* heap);
+extern "C" void* konan_heap_calloc_impl(void* heap, size_t count, size_t size);
+extern "C" void* konan_heap_calloc_aligned_impl(void* heap, size_t count, size_t size, size_t alignment);
+extern "C" void konan_heap_trim_impl(void* heap);
 #define calloc_aligned_impl konan_calloc_aligned_impl
+#define heap_create_impl konan_heap_create_impl
+#define heap_destroy_impl konan_heap_destroy_impl
+#define heap_calloc_impl konan_heap_calloc_impl
+#define heap_calloc_aligned_impl konan_heap_calloc_aligned_impl
+#define heap_trim_impl konan_heap_trim_impl
 #endif
 
 void* calloc(size_t count, size_t size) {
@@ -307,6 +352,72 @@ void free(void* pointer) {
   free_impl(pointer);
 }
 
+void* createHeap() {
+  return heap_create_impl();
+}
+
+void destroyHeap(void* heap) {
+  heap_destroy_impl(heap);
+}
+
+void* callocInHeap(void* heap, size_t count, size_t size) {
+  return heap_calloc_impl(heap, count, size);
+}
+
+void* callocInHeapAligned(void* heap, size_t count, size_t size, size_t alignment) {
+  return heap_calloc_aligned_impl(heap, count, size, alignment);
+}
+
+void trimHeap(void* heap) {
+  heap_trim_impl(heap);
+}
+
+#if KONAN_WINDOWS || KONAN_WASM || KONAN_ZEPHYR
+void* mapMemory(size_t size) {
+  return nullptr;
+}
+
+void unmapMemory(void* pointer, size_t size) {
+  RuntimeAssert(false, "Memory mapping is not supported");
+}
+
+bool extendMapping(void* pointer, size_t size, size_t newSize) {
+  return false;
+}
+
+bool discardMemory(void* pointer, size_t size) {
+  return false;
+}
+#else
+void* mapMemory(size_t size) {
+  void* result = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  return result == MAP_FAILED ? nullptr : result;
+}
+
+void unmapMemory(void* pointer, size_t size) {
+  ::munmap(pointer, size);
+}
+
+bool extendMapping(void* pointer, size_t size, size_t newSize) {
+#if KONAN_LINUX || defined(KONAN_ANDROID)
+  // Without MREMAP_MAYMOVE the mapping either grows in place, or stays as is.
+  return ::mremap(pointer, size, newSize, 0) != MAP_FAILED;
+#else
+  return false;
+#endif
+}
+
+bool discardMemory(void* pointer, size_t size) {
+#if KONAN_LINUX || defined(KONAN_ANDROID)
+  return ::madvise(pointer, size, MADV_DONTNEED) == 0;
+#elif defined(MADV_FREE)
+  return ::madvise(pointer, size, MADV_FREE) == 0;
+#else
+  return false;
+#endif
+}
+#endif
+
 #if KONAN_INTERNAL_NOW
 
 #ifdef KONAN_ZEPHYR
@@ -39,6 +39,10 @@ RUNTIME_NORETURN void exit(int32_t status);
 
 // Thread control.
 void onThreadExit(void (*destructor)(void*), void* destructorParameter);
+// Hints the processor that the thread is busy waiting for another one.
+void spinPause();
+// Gives the rest of the time slice of the thread to other threads.
+void yieldThread();
 
 // String/byte operations.
 // memcpy/memmove/memcmp are not here intentionally, as frequently implemented/optimized
@@ -78,6 +82,22 @@ void *memset(void *b, int c, size_t len);
 void* calloc(size_t count, size_t size);
 void* calloc_aligned(size_t count, size_t size, size_t alignment);
 void free(void* ptr);
+// Allocator heap confined to the current thread, nullptr if not supported by the allocator.
+// Memory allocated in the heap is released with free(), but only the creating thread may allocate in it.
+void* createHeap();
+void destroyHeap(void* heap);
+void* callocInHeap(void* heap, size_t count, size_t size);
+void* callocInHeapAligned(void* heap, size_t count, size_t size, size_t alignment);
+// Returns memory not in use by the heap, which may be nullptr, and by the allocator in general to the OS.
+void trimHeap(void* heap);
+// Zeroed memory mapped directly from the OS, nullptr if failed or not supported by the target.
+void* mapMemory(size_t size);
+void unmapMemory(void* pointer, size_t size);
+// Extends the mapping without moving it, false if address space after it is in use or not supported by the target.
+bool extendMapping(void* pointer, size_t size, size_t newSize);
+// Lets the OS take back pages of the allocated memory, which read as zeroes or stale data if touched again.
+// Pointer and size must be page aligned, false if not supported by the target.
+bool discardMemory(void* pointer, size_t size);
 
 // Time operations.
 uint64_t getTimeMillis();
@@ -45,7 +45,8 @@ enum {
   INIT_GLOBALS = 0,
   INIT_THREAD_LOCAL_GLOBALS = 1,
   DEINIT_THREAD_LOCAL_GLOBALS = 2,
-  DEINIT_GLOBALS = 3
+  DEINIT_GLOBALS = 3,
+  VISIT_GLOBALS = 4
 };
 
 enum {
@@ -87,13 +88,13 @@ inline bool isValidRuntime() {
 
 volatile int aliveRuntimesCount = 0;
 
-RuntimeState* initRuntime() {
+RuntimeState* initRuntime(bool threadBound) {
   SetKonanTerminateHandler();
   RuntimeState* result = konanConstructInstance<RuntimeState>();
   if (!result) return kInvalidRuntime;
   RuntimeCheck(!isValidRuntime(), "No active runtimes allowed");
   ::runtimeState = result;
-  result->memoryState = InitMemory();
+  result->memoryState = InitMemory(threadBound);
   result->worker = WorkerInit(true);
   bool firstRuntime = atomicAdd(&aliveRuntimesCount, 1) == 1;
   // Keep global variables in state as well.
@@ -144,7 +145,8 @@ void AppendToInitializersTail(InitNode *next) {
 
 void Kotlin_initRuntimeIfNeeded() {
   if (!isValidRuntime()) {
-    initRuntime();
+    // Such runtime is destroyed by the same thread, see Kotlin_deinitRuntimeCallback().
+    initRuntime(true);
     RuntimeCheck(updateStatusIf(::runtimeState, SUSPENDED, RUNNING), "Cannot transition state to RUNNING for init");
     // Register runtime deinit function at thread cleanup.
     konan::onThreadExit(Kotlin_deinitRuntimeCallback, runtimeState);
@@ -159,7 +161,7 @@ void Kotlin_deinitRuntimeIfNeeded() {
 }
 
 RuntimeState* Kotlin_createRuntime() {
-  return initRuntime();
+  return initRuntime(false);
 }
 
 void Kotlin_destroyRuntime(RuntimeState* state) {
@@ -276,6 +278,14 @@ bool Kotlin_memoryLeakCheckerEnabled() {
   return g_checkLeaks;
 }
 
+void Kotlin_visitGlobalRoots(MemoryState* memory) {
+  InitOrDeinitGlobalVariables(VISIT_GLOBALS, memory);
+}
+
+bool Kotlin_isMainThread() {
+  return isMainThread != 0;
+}
+
 KBoolean Konan_Platform_getMemoryLeakChecker() {
   return g_checkLeaks;
 }
@@ -21,6 +21,7 @@
 
 struct RuntimeState;
 struct InitNode;
+struct MemoryState;
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,11 @@ void Kotlin_zeroOutTLSGlobals();
 
 bool Kotlin_memoryLeakCheckerEnabled();
 
+// Reports all global variables of the reference type with VisitGlobalRoot().
+void Kotlin_visitGlobalRoots(MemoryState* memory);
+
+bool Kotlin_isMainThread();
+
 #ifdef __cplusplus
 }
 #endif
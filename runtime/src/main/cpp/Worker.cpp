@@ -25,9 +25,20 @@
 #if WITH_WORKERS
 #include <pthread.h>
 #include "PthreadUtils.h"
+
+#if KONAN_LINUX || KONAN_ANDROID
+#define USE_FUTEX 1
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define USE_FUTEX 0
+#endif
 #endif
 
 #include "Alloc.h"
+#include "Atomic.h"
 #include "Exceptions.h"
 #include "KAssert.h"
 #include "Memory.h"
@@ -40,6 +51,7 @@ extern "C" {
 RUNTIME_NORETURN void ThrowWorkerInvalidState();
 RUNTIME_NORETURN void ThrowWorkerUnsupported();
 OBJ_GETTER(WorkerLaunchpad, KRef);
+OBJ_GETTER(WorkerBatchLaunchpad, KRef, KInt);
 
 }  // extern "C"
 
@@ -48,6 +60,8 @@ OBJ_GETTER(WorkerLaunchpad, KRef);
 namespace {
 
 class Future;
+class FutureGroup;
+class WorkerPool;
 
 enum {
   INVALID = 0,
@@ -68,14 +82,19 @@ enum JobKind {
   // Order is important in sense that all job kinds after this one is considered
   // processed for APIs returning request process status.
   JOB_REGULAR = 2,
-  JOB_EXECUTE_AFTER = 3
+  JOB_EXECUTE_AFTER = 3,
+  JOB_BATCH = 4
 };
 
 enum class WorkerKind {
   kNative,  // Workers created using Worker.start public API.
+  kPool,    // Threads of pools created using WorkerPool.start public API.
   kOther,   // Any other kind of workers.
 };
 
+// Waits are cut at 10_000_000 seconds, aka 115 days, to protect from potential overflow.
+constexpr KLong kMaxWaitMicroseconds = 10LL * 1000 * 1000 * 1000 * 1000;
+
 struct Job {
   enum JobKind kind;
   union {
@@ -93,19 +112,327 @@ struct Job {
 
     struct {
       KNativePtr operation;
-      KLong whenExecute;
     } executeAfter;
+
+    // Elements [first, first + count) of the group.
+    struct {
+      FutureGroup* group;
+      KInt first;
+      KInt count;
+    } batch;
+  };
+};
+
+// Unbounded multi-producer single-consumer queue of jobs, see "Non-intrusive MPSC node-based queue"
+// by Dmitry Vyukov. Pushing never blocks, popping is only done by the owning worker.
+class JobQueue {
+ public:
+  JobQueue() : head_(&stub_), tail_(&stub_) {
+    stub_.next = nullptr;
+  }
+
+  ~JobQueue() {
+    RuntimeAssert(empty(), "Queue must be drained");
+    if (tail_ != &stub_) konanDestructInstance(tail_);
+  }
+
+  void push(const Job& job) {
+    Node* node = konanConstructInstance<Node>();
+    RuntimeCheck(node != nullptr, "Cannot alloc memory");
+    node->job = job;
+    node->next = nullptr;
+    Node* previous = __atomic_exchange_n(&head_, node, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&previous->next, node, __ATOMIC_RELEASE);
+  }
+
+  // Called by the owner only. May miss a job which is being pushed concurrently,
+  // its producer notifies the owner once the job is visible.
+  bool pop(Job* job) {
+    Node* tail = tail_;
+    Node* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next == nullptr) return false;
+    // Popped node becomes the new stub.
+    *job = next->job;
+    tail_ = next;
+    if (tail != &stub_) konanDestructInstance(tail);
+    return true;
+  }
+
+  // Called by the owner only.
+  bool empty() {
+    return __atomic_load_n(&tail_->next, __ATOMIC_ACQUIRE) == nullptr;
+  }
+
+ private:
+  struct Node {
+    Node* next;
+    Job job;
   };
+
+  Node* head_;
+  Node* tail_;
+  Node stub_;
 };
 
-struct JobCompare {
-  bool operator() (const Job& lhs, const Job& rhs) const {
-    RuntimeAssert(lhs.kind == JOB_EXECUTE_AFTER && rhs.kind == JOB_EXECUTE_AFTER, "Must be delayed jobs");
-    return lhs.executeAfter.whenExecute < rhs.executeAfter.whenExecute;
+// Lets a thread wait for a condition changed by other threads, with no locks or system calls on
+// the notifying side unless someone waits, see "eventcount" by Dmitry Vyukov. Waiting looks like:
+//   auto key = prepareWait();
+//   if (condition) cancelWait(); else commitWait(key, timeout);
+class EventCount {
+ public:
+  EventCount() {
+#if !USE_FUTEX
+    pthread_mutex_init(&lock_, nullptr);
+    pthread_cond_init(&cond_, nullptr);
+#endif
+  }
+
+  ~EventCount() {
+#if !USE_FUTEX
+    pthread_mutex_destroy(&lock_);
+    pthread_cond_destroy(&cond_);
+#endif
+  }
+
+  uint32_t prepareWait() {
+    atomicAdd(&waiters_, 1);
+    return atomicGet(&epoch_);
+  }
+
+  void cancelWait() {
+    atomicAdd(&waiters_, -1);
+  }
+
+  // Returns once notified or after timeoutMicroseconds, waits forever if it's negative. May return spuriously.
+  void commitWait(uint32_t key, KLong timeoutMicroseconds) {
+#if USE_FUTEX
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMicroseconds / 1000000;
+    timeout.tv_nsec = (timeoutMicroseconds % 1000000) * 1000;
+    syscall(SYS_futex, &epoch_, FUTEX_WAIT_PRIVATE, key, timeoutMicroseconds >= 0 ? &timeout : nullptr, nullptr, 0);
+#else
+    pthread_mutex_lock(&lock_);
+    if (atomicGet(&epoch_) == key) {
+      if (timeoutMicroseconds < 0)
+        pthread_cond_wait(&cond_, &lock_);
+      else
+        WaitOnCondVar(&cond_, &lock_, timeoutMicroseconds * 1000LL);
+    }
+    pthread_mutex_unlock(&lock_);
+#endif
+    atomicAdd(&waiters_, -1);
+  }
+
+  void notify() {
+    // Pairs with prepareWait(): either the waiter sees the new epoch, or we see the waiter.
+    atomicAdd(&epoch_, 1u);
+    if (atomicGet(&waiters_) == 0) return;
+#if USE_FUTEX
+    syscall(SYS_futex, &epoch_, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    pthread_mutex_lock(&lock_);
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&lock_);
+#endif
   }
+
+ private:
+  uint32_t epoch_ = 0;
+  KInt waiters_ = 0;
+#if !USE_FUTEX
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+#endif
 };
 
-typedef KStdOrderedSet<Job, JobCompare> DelayedJobSet;
+// Hierarchical timer wheel of delayed operations, see "Hashed and Hierarchical Timing Wheels" by George Varghese
+// and Tony Lauck. Level 0 has a slot per tick, every next level has a slot per full turn of the previous one,
+// and operations move to the lower levels as their time comes closer. So adding and cancelling are O(1),
+// and finding the closest operation only looks at a bitmap of occupied slots per level.
+// Operations are stored in a pool of nodes and are addressed by handles, combining index of the node with
+// its generation, so that a stale handle never cancels a reused node. Guarded by the owning worker's lock.
+class TimerWheel {
+ public:
+  TimerWheel() {
+    for (int slot = 0; slot < kLevels * kLevelSize; slot++) {
+      heads_[slot] = tails_[slot] = -1;
+    }
+    for (int level = 0; level < kLevels; level++) {
+      occupied_[level] = 0;
+    }
+  }
+
+  // Adds an operation to be executed after `delay` microseconds since `now`, returns its handle.
+  KLong add(KNativePtr operation, KLong now, KLong delay) {
+    if (size_ == 0 && currentTick_ < (now >> kTickShift)) currentTick_ = now >> kTickShift;
+    int32_t index = free_;
+    if (index >= 0) {
+      free_ = nodes_[index].next;
+    } else {
+      index = nodes_.size();
+      nodes_.push_back(Node());
+    }
+    Node& node = nodes_[index];
+    node.operation = operation;
+    // Saturate, as delay may be as large as Long.MAX_VALUE.
+    node.deadline = delay < kMaxDelay - now ? now + delay : kMaxDelay;
+    // Rounded up, so that the operation is never executed too early. The current tick is processed already.
+    node.expires = (node.deadline + kTickMask) >> kTickShift;
+    if (node.expires <= currentTick_) node.expires = currentTick_ + 1;
+    link(index);
+    size_++;
+    return (static_cast<KLong>(node.generation) << 32) | static_cast<uint32_t>(index);
+  }
+
+  // Removes an operation, returns it or nullptr if it was removed already.
+  KNativePtr cancel(KLong handle) {
+    uint32_t index = static_cast<uint32_t>(handle);
+    if (index >= nodes_.size()) return nullptr;
+    Node& node = nodes_[index];
+    if (node.slot < 0 || node.generation != static_cast<uint32_t>(handle >> 32)) return nullptr;
+    KNativePtr operation = node.operation;
+    remove(index);
+    return operation;
+  }
+
+  // Calls `due` for every operation which shall be executed by `now`, and removes it.
+  // Returns microseconds until the wheel needs to be advanced again, or -1 if it is empty.
+  template <typename F>
+  KLong advance(KLong now, F due) {
+    KLong nowTick = now >> kTickShift;
+    while (size_ > 0) {
+      // Jump straight to the next tick which has something to do, skipping empty slots.
+      KLong tick = nextTick();
+      if (tick > nowTick) return (tick << kTickShift) - now;
+      currentTick_ = tick;
+      // Move operations of the slots whose turn has come to the lower levels.
+      for (int level = 1; level < kLevels && (tick & ((KLong(1) << (kLevelBits * level)) - 1)) == 0; level++) {
+        int32_t slot = level * kLevelSize + ((tick >> (kLevelBits * level)) & kLevelMask);
+        int32_t index = heads_[slot];
+        heads_[slot] = tails_[slot] = -1;
+        occupied_[level] &= ~(1ULL << (slot & kLevelMask));
+        while (index >= 0) {
+          int32_t next = nodes_[index].next;
+          link(index);
+          index = next;
+        }
+      }
+      int32_t slot = tick & kLevelMask;
+      while (heads_[slot] >= 0) {
+        int32_t index = heads_[slot];
+        KNativePtr operation = nodes_[index].operation;
+        remove(index);
+        due(operation);
+      }
+    }
+    if (currentTick_ < nowTick) currentTick_ = nowTick;
+    return -1;
+  }
+
+  template <typename F>
+  void forEach(F function) {
+    for (auto& node : nodes_) {
+      if (node.slot >= 0) function(node.operation);
+    }
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  // Tick is 128 microseconds, and 6 levels of 64 slots cover about 100 days. Operations planned further
+  // stay at the last level until they get closer.
+  static constexpr int kTickShift = 7;
+  static constexpr KLong kTickMask = (KLong(1) << kTickShift) - 1;
+  static constexpr int kLevelBits = 6;
+  static constexpr int kLevelSize = 1 << kLevelBits;
+  static constexpr int kLevelMask = kLevelSize - 1;
+  static constexpr int kLevels = 6;
+  static constexpr KLong kMaxDelay = (KLong(1) << 62) - 1;
+
+  struct Node {
+    KNativePtr operation;
+    // In microseconds.
+    KLong deadline;
+    // In ticks.
+    KLong expires;
+    // Links in the list of the slot, or in the free list.
+    int32_t previous;
+    int32_t next;
+    // -1 if the node is free.
+    int32_t slot;
+    uint32_t generation;
+  };
+
+  // Puts a node to the slot of the lowest level which could hold it, at the end of the slot's list.
+  void link(int32_t index) {
+    Node& node = nodes_[index];
+    KLong expires = node.expires;
+    RuntimeAssert(expires >= currentTick_, "Must not be in the past");
+    int level = 0;
+    while (level < kLevels - 1 && expires - currentTick_ >= (KLong(1) << (kLevelBits * (level + 1)))) level++;
+    if (expires - currentTick_ >= (KLong(1) << (kLevelBits * kLevels)))
+      expires = currentTick_ + (KLong(1) << (kLevelBits * kLevels)) - 1;
+    int32_t position = (expires >> (kLevelBits * level)) & kLevelMask;
+    int32_t slot = level * kLevelSize + position;
+    node.slot = slot;
+    node.next = -1;
+    node.previous = tails_[slot];
+    if (tails_[slot] >= 0)
+      nodes_[tails_[slot]].next = index;
+    else
+      heads_[slot] = index;
+    tails_[slot] = index;
+    occupied_[level] |= 1ULL << position;
+  }
+
+  // Unlinks a node from its slot and frees it.
+  void remove(int32_t index) {
+    Node& node = nodes_[index];
+    int32_t slot = node.slot;
+    if (node.previous >= 0)
+      nodes_[node.previous].next = node.next;
+    else
+      heads_[slot] = node.next;
+    if (node.next >= 0)
+      nodes_[node.next].previous = node.previous;
+    else
+      tails_[slot] = node.previous;
+    if (heads_[slot] < 0) occupied_[slot / kLevelSize] &= ~(1ULL << (slot & kLevelMask));
+    node.slot = -1;
+    node.operation = nullptr;
+    node.generation++;
+    node.next = free_;
+    free_ = index;
+    size_--;
+  }
+
+  // The closest tick when a slot of some level needs to be processed.
+  KLong nextTick() const {
+    KLong result = -1;
+    for (int level = 0; level < kLevels; level++) {
+      uint64_t occupied = occupied_[level];
+      if (occupied == 0) continue;
+      int shift = kLevelBits * level;
+      // Slots of the level are processed at multiples of its slot span, starting after the current tick.
+      KLong base = (currentTick_ >> shift) + 1;
+      int position = base & kLevelMask;
+      uint64_t rotated = position == 0 ? occupied : (occupied >> position) | (occupied << (kLevelSize - position));
+      KLong tick = (base + __builtin_ctzll(rotated)) << shift;
+      if (result < 0 || tick < result) result = tick;
+    }
+    RuntimeAssert(result > currentTick_, "Must be in the future");
+    return result;
+  }
+
+  KStdVector<Node> nodes_;
+  int32_t free_ = -1;
+  int32_t heads_[kLevels * kLevelSize];
+  int32_t tails_[kLevels * kLevelSize];
+  uint64_t occupied_[kLevels];
+  // The last processed tick.
+  KLong currentTick_ = 0;
+  size_t size_ = 0;
+};
 
 }  // namespace
 
@@ -117,28 +444,78 @@ class Worker {
         errorReporting_(errorReporting) {
     name_ = customName != nullptr ? CreateStablePointer(customName) : nullptr;
     pthread_mutex_init(&lock_, nullptr);
-    pthread_cond_init(&cond_, nullptr);
   }
 
   ~Worker();
 
   void startEventLoop();
 
+  void startThread(void* (*routine)(void*), void* argument);
+
   void putJob(Job job, bool toFront);
-  void putDelayedJob(Job job);
+  // Returns handle of the job, to cancel it with cancelDelayedJob().
+  KLong putDelayedJob(KNativePtr operation, KLong afterMicroseconds);
+  bool cancelDelayedJob(KLong handle);
 
   bool waitDelayed(bool blocking);
 
   Job getJob(bool blocking);
 
-  KLong checkDelayedLocked();
+  bool popJob(Job* job);
 
-  bool waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining);
+  bool hasJobs();
+
+  KLong checkDelayed();
+
+  // Returns 0 if there are jobs to process, otherwise microseconds until the closest delayed job, or -1.
+  KLong checkQueue();
+
+  bool waitForQueue(KLong timeoutMicroseconds, KLong* remaining);
 
   JobKind processQueueElement(bool blocking);
 
+  void processRegularJob(const Job& job);
+
+  void processBatchJob(const Job& job);
+
+  // Runs the job function with the argument, returns its transferred result. Sets `ok` if it hasn't thrown.
+  KNativePtr runJobFunction(KRef (*function)(KRef, ObjHeader**), KNativePtr argument, KInt transferMode, bool* ok);
+
   bool park(KLong timeoutMicroseconds, bool process);
 
+  // Parks the worker until `ready` returns true, processing its jobs meanwhile, like park() does.
+  // Someone who makes `ready` true shall call wakeUp() after that. Returns false if the worker was terminated.
+  template <typename Predicate>
+  bool parkUntil(Predicate ready) {
+    // Set once a job was put back, such as termination waiting for the delayed jobs, to not spin on it.
+    bool deferred = false;
+    while (!terminated_) {
+      // Prepare to wait before checking, so that wakeUp() after the checks is not missed.
+      auto key = event_.prepareWait();
+      if (ready()) {
+        event_.cancelWait();
+        return true;
+      }
+      if (!deferred && hasJobs()) {
+        event_.cancelWait();
+        deferred = processQueueElement(false) == JOB_NONE;
+        continue;
+      }
+      deferred = false;
+      KLong closestToRunMicroseconds = checkDelayed();
+      if (closestToRunMicroseconds == 0) {
+        event_.cancelWait();
+        continue;
+      }
+      if (closestToRunMicroseconds > kMaxWaitMicroseconds)
+        closestToRunMicroseconds = kMaxWaitMicroseconds;
+      event_.commitWait(key, closestToRunMicroseconds);
+    }
+    return false;
+  }
+
+  void wakeUp() { event_.notify(); }
+
   KInt id() const { return id_; }
 
   bool errorReporting() const { return errorReporting_; }
@@ -149,20 +526,31 @@ class Worker {
 
   pthread_t thread() const { return thread_; }
 
+  void setPool(WorkerPool* pool) { pool_ = pool; }
+
  private:
   KInt id_;
   WorkerKind kind_;
-  KStdDeque<Job> queue_;
-  DelayedJobSet delayed_;
+  JobQueue queue_;
+  // Jobs to be processed before anything in queue_, such as immediate termination requests.
+  JobQueue urgentQueue_;
+  // Guarded by lock_.
+  TimerWheel delayed_;
+  // Operations of the cancelled delayed jobs, which may be not frozen and so are disposed by the worker itself.
+  // Guarded by lock_.
+  KStdVector<KNativePtr> cancelled_;
   // Stable pointer with worker's name.
   KNativePtr name_;
-  // Lock and condition for waiting on the queue.
+  // Lock for the delayed jobs.
   pthread_mutex_t lock_;
-  pthread_cond_t cond_;
+  // Notified whenever a job is added, to wake up the worker waiting for jobs.
+  EventCount event_;
   // If errors to be reported on console.
   bool errorReporting_;
   bool terminated_ = false;
   pthread_t thread_ = 0;
+  // Pool this worker is a thread of, woken up when jobs are put into the worker's own queue.
+  WorkerPool* pool_ = nullptr;
 };
 
 #else  // WITH_WORKERS
@@ -178,9 +566,11 @@ namespace {
 
 THREAD_LOCAL_VARIABLE Worker* g_worker = nullptr;
 
-KNativePtr transfer(ObjHolder* holder, KInt mode) {
+// Checking if the subgraph is fresh is cheap, but wasted if it is not, so only done where it usually is.
+KNativePtr transfer(ObjHolder* holder, KInt mode, bool maybeFresh = false) {
   void* result = CreateStablePointer(holder->obj());
-  if (!ClearSubgraphReferences(holder->obj(), mode == CHECKED)) {
+  bool cleared = maybeFresh && mode == CHECKED && ClearFreshSubgraphReferences(holder->obj());
+  if (!cleared && !ClearSubgraphReferences(holder->obj(), mode == CHECKED)) {
     DisposeStablePointer(result);
     ThrowWorkerInvalidState();
   }
@@ -256,201 +646,949 @@ class Future {
   pthread_cond_t cond_;
 };
 
-class State {
+// Results of a batch of jobs. Unlike separate futures, all elements share a single array, lock and
+// completion counter, and completions don't wake up those waiting for any future.
+class FutureGroup {
  public:
-  State() {
+  FutureGroup(KInt id, KInt size, KInt transferMode)
+      : id_(id),
+        size_(size),
+        transferMode_(transferMode) {
+    elements_ = reinterpret_cast<Element*>(konanAllocMemory(size * sizeof(Element)));
+    RuntimeCheck(elements_ != nullptr, "Cannot alloc memory");
+    for (KInt index = 0; index < size; index++) {
+      elements_[index].state = SCHEDULED;
+    }
     pthread_mutex_init(&lock_, nullptr);
     pthread_cond_init(&cond_, nullptr);
-
-    currentWorkerId_ = 1;
-    currentFutureId_ = 1;
-    currentVersion_ = 0;
   }
 
-  ~State() {
-    // TODO: some sanity check here?
+  ~FutureGroup() {
+    for (KInt index = 0; index < size_; index++) {
+      // Arguments of cancelled jobs, or results no one cared to consume.
+      if (elements_[index].value != nullptr) DisposeStablePointer(elements_[index].value);
+    }
+    konanFreeMemory(elements_);
     pthread_mutex_destroy(&lock_);
     pthread_cond_destroy(&cond_);
   }
 
-  Worker* addWorkerUnlocked(bool errorReporting, KRef customName, WorkerKind kind) {
-    Worker* worker = nullptr;
-    {
-      Locker locker(&lock_);
-      worker = konanConstructInstance<Worker>(nextWorkerId(), errorReporting, customName, kind);
-      if (worker == nullptr) return nullptr;
-      workers_[worker->id()] = worker;
-    }
-    GC_RegisterWorker(worker);
-    return worker;
+  // Group is referenced by the state while not consumed, by the jobs not processed yet,
+  // and by the threads operating on it.
+  void retain() {
+    atomicAdd(&refCount_, 1);
   }
 
-  void removeWorkerUnlocked(KInt id) {
-    Locker locker(&lock_);
-    auto it = workers_.find(id);
-    if (it == workers_.end()) return;
-    Worker* worker = it->second;
-    if (worker->kind() == WorkerKind::kNative) {
-      terminating_native_workers_[id] = worker->thread();
-    }
-    workers_.erase(it);
+  void release() {
+    if (atomicAdd(&refCount_, -1) == 0) konanDestructInstance(this);
   }
 
-  void destroyWorkerUnlocked(Worker* worker) {
-    {
+  KInt id() const { return id_; }
+  KInt size() const { return size_; }
+  KInt transferMode() const { return transferMode_; }
+
+  // Called before the group is submitted.
+  void setArgument(KInt index, KNativePtr argument) {
+    elements_[index].value = argument;
+  }
+
+  // Called by the thread executing the element.
+  KNativePtr takeArgument(KInt index) {
+    KNativePtr result = elements_[index].value;
+    elements_[index].value = nullptr;
+    return result;
+  }
+
+  void storeResult(KInt index, KNativePtr result, KInt state) {
+    Element& element = elements_[index];
+    element.value = result;
+    atomicSet(&element.state, state);
+    // Append the element to the completion order, awaitAny() follows it.
+    KInt slot = atomicAdd(&completed_, 1) - 1;
+    atomicSet(&elements_[slot].completedIndex, index + 1);
+    if (atomicGet(&waiters_) != 0) {
       Locker locker(&lock_);
-      auto id = worker->id();
-      auto it = workers_.find(id);
-      if (it != workers_.end()) {
-        workers_.erase(it);
-      }
+      pthread_cond_broadcast(&cond_);
     }
-    GC_UnregisterWorker(worker);
-    konanDestructInstance(worker);
   }
 
-  Future* addJobToWorkerUnlocked(
-      KInt id, KNativePtr jobFunction, KNativePtr jobArgument, bool toFront, KInt transferMode) {
-    Future* future = nullptr;
-    Worker* worker = nullptr;
-    Locker locker(&lock_);
+  void cancel(KInt index) {
+    KNativePtr argument = takeArgument(index);
+    if (argument != nullptr) DisposeStablePointer(argument);
+    storeResult(index, nullptr, CANCELLED);
+  }
 
-    auto it = workers_.find(id);
-    if (it == workers_.end()) return nullptr;
-    worker = it->second;
+  KInt state(KInt index) {
+    return atomicGet(&elements_[index].state);
+  }
 
-    future = konanConstructInstance<Future>(nextFutureId());
-    futures_[future->id()] = future;
+  bool awaitAll(KInt millis) {
+    return waitFor(millis, [this] { return atomicGet(&completed_) == size_; });
+  }
 
-    Job job;
-    if (jobFunction == nullptr) {
-      job.kind = JOB_TERMINATE;
-      job.terminationRequest.future = future;
-      job.terminationRequest.waitDelayed = !toFront;
-    } else {
-      job.kind = JOB_REGULAR;
-      job.regularJob.function = reinterpret_cast<KRef (*)(KRef, ObjHeader**)>(jobFunction);
-      job.regularJob.argument = jobArgument;
-      job.regularJob.future = future;
-      job.regularJob.transferMode = transferMode;
+  // Returns elements in the order of completion, each one once, or -1 on timeout or if all were returned.
+  KInt awaitAny(KInt millis) {
+    while (true) {
+      KInt cursor = atomicGet(&anyCursor_);
+      if (cursor == size_) return -1;
+      KInt* completedIndex = &elements_[cursor].completedIndex;
+      if (!waitFor(millis, [completedIndex] { return atomicGet(completedIndex) != 0; })) return -1;
+      if (compareAndSet(&anyCursor_, cursor, cursor + 1)) return atomicGet(completedIndex) - 1;
     }
+  }
 
-    worker->putJob(job, toFront);
-
-    return future;
+  // Waits for the element and takes its result, returns the state the element had.
+  // Sets `last` if all elements are consumed now.
+  KInt consume(KInt index, ObjHeader** result, bool* last) {
+    waitFor(-1, [this, index] { return state(index) != SCHEDULED; });
+    KInt elementState = state(index);
+    if (elementState == INVALID || !compareAndSet(&elements_[index].state, elementState, static_cast<KInt>(INVALID)))
+      ThrowWorkerInvalidState();
+    if (elementState == COMPUTED) {
+      AdoptStablePointer(takeArgument(index), result);
+    }
+    *last = atomicAdd(&consumed_, 1) == size_;
+    return elementState;
   }
 
-  bool executeJobAfterInWorkerUnlocked(KInt id, KRef operation, KLong afterMicroseconds) {
-    Worker* worker = nullptr;
-    Locker locker(&lock_);
+ private:
+  struct Element {
+    // Stable pointer with the job argument, and then with its result.
+    KNativePtr value;
+    KInt state;
+    // Index + 1 of the element completed in this order, 0 if not yet.
+    KInt completedIndex;
+  };
 
-    auto it = workers_.find(id);
-    if (it == workers_.end()) {
-      return false;
+  template <typename Predicate>
+  bool waitFor(KInt millis, Predicate predicate) {
+    if (predicate()) return true;
+    Locker locker(&lock_);
+    // Pairs with storeResult(): either it sees the waiter, or we see the completion.
+    atomicAdd(&waiters_, 1);
+    KLong deadline = millis < 0 ? -1 : konan::getTimeMicros() + millis * 1000LL;
+    while (!predicate()) {
+      if (deadline < 0) {
+        pthread_cond_wait(&cond_, &lock_);
+        continue;
+      }
+      KLong now = konan::getTimeMicros();
+      if (now >= deadline) break;
+      WaitOnCondVar(&cond_, &lock_, (deadline - now) * 1000LL);
     }
-    worker = it->second;
-    Job job;
-    job.kind = JOB_EXECUTE_AFTER;
-    job.executeAfter.operation = CreateStablePointer(operation);
-    if (afterMicroseconds == 0) {
-      worker->putJob(job, false);
-    } else {
-      job.executeAfter.whenExecute = konan::getTimeMicros() + afterMicroseconds;
-      worker->putDelayedJob(job);
+    atomicAdd(&waiters_, -1);
+    return predicate();
+  }
+
+  KInt id_;
+  KInt size_;
+  KInt transferMode_;
+  Element* elements_;
+  // Lock and condition for waiting on the group.
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  // Counters below are only accessed atomically.
+  KInt refCount_ = 1;
+  KInt completed_ = 0;
+  KInt consumed_ = 0;
+  KInt anyCursor_ = 0;
+  KInt waiters_ = 0;
+};
+
+// Releases the group reference acquired by State::findGroupUnlocked().
+class FutureGroupReference {
+ public:
+  explicit FutureGroupReference(FutureGroup* group) : group_(group) {}
+  ~FutureGroupReference() {
+    group_->release();
+  }
+
+  FutureGroup* operator->() const { return group_; }
+
+ private:
+  FutureGroup* group_;
+};
+
+// Bounded channel of transferred object graphs, see "Bounded MPMC queue" by Dmitry Vyukov. Sending and receiving
+// take no locks, only blocked workers register under the lock, to be woken up on changes.
+class WorkerChannel {
+ public:
+  WorkerChannel(KInt id, KInt capacity) : id_(id), capacity_(capacity) {
+    KLong size = 1;
+    while (size < capacity) size <<= 1;
+    cells_ = konanAllocArray<Cell>(size);
+    RuntimeCheck(cells_ != nullptr, "Cannot alloc memory");
+    for (KLong index = 0; index < size; index++) {
+      cells_[index].sequence = index;
     }
-    return true;
+    mask_ = size - 1;
+    pthread_mutex_init(&lock_, nullptr);
   }
 
-  // Returns `true` if something was indeed processed.
-  bool processQueueUnlocked(KInt id) {
-    // Can only process queue of the current worker.
-    if (::g_worker == nullptr || id != ::g_worker->id()) ThrowWorkerInvalidState();
-    JobKind kind = ::g_worker->processQueueElement(false);
-    return kind != JOB_NONE && kind != JOB_TERMINATE;
+  ~WorkerChannel() {
+    // Messages no one cared to receive.
+    KNativePtr message;
+    while (pop(&message)) DisposeStablePointer(message);
+    konanFreeMemory(cells_);
+    pthread_mutex_destroy(&lock_);
   }
 
-  bool parkUnlocked(KInt id, KLong timeoutMicroseconds, KBoolean process) {
-      // Can only park current worker.
-      if (::g_worker == nullptr || id != ::g_worker->id()) ThrowWorkerInvalidState();
-      return ::g_worker->park(timeoutMicroseconds, process);
+  // Channel is referenced by the state until it is closed and drained, and by the threads operating on it.
+  void retain() {
+    atomicAdd(&refCount_, 1);
   }
 
-  KInt stateOfFutureUnlocked(KInt id) {
-    Locker locker(&lock_);
-    auto it = futures_.find(id);
-    if (it == futures_.end()) return INVALID;
-    return it->second->state();
+  void release() {
+    if (atomicAdd(&refCount_, -1) == 0) konanDestructInstance(this);
   }
 
-  OBJ_GETTER(consumeFutureUnlocked, KInt id) {
-    Future* future = nullptr;
-    {
-      Locker locker(&lock_);
-      auto it = futures_.find(id);
-      if (it == futures_.end()) ThrowWorkerInvalidState();
-      future = it->second;
+  KInt id() const { return id_; }
 
+  // Reserves room for a message, so that the following push() always succeeds.
+  bool reserve() {
+    KInt size = atomicGet(&size_);
+    while (size < capacity_) {
+      if (compareAndSet(&size_, size, size + 1)) return true;
+      size = atomicGet(&size_);
     }
+    return false;
+  }
 
-    KRef result = future->consumeResultUnlocked(OBJ_RESULT);
+  // Called if the reserved message couldn't be produced.
+  void cancelReservation() {
+    atomicAdd(&size_, -1);
+    notifyWaiters();
+  }
 
-    {
-       Locker locker(&lock_);
-       auto it = futures_.find(id);
-       if (it != futures_.end()) {
-         futures_.erase(it);
-         konanDestructInstance(future);
-       }
+  void push(KNativePtr message) {
+    uint64_t position = __atomic_load_n(&enqueuePosition_, __ATOMIC_RELAXED);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[position & mask_];
+      int64_t difference = static_cast<int64_t>(__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) - position);
+      if (difference == 0) {
+        if (__atomic_compare_exchange_n(
+            &enqueuePosition_, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+      } else {
+        // Room is reserved, so the cell can only be taken by another sender.
+        RuntimeAssert(difference > 0, "Channel must not be full");
+        position = __atomic_load_n(&enqueuePosition_, __ATOMIC_RELAXED);
+      }
     }
-
-    return result;
+    cell->message = message;
+    __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+    notifyWaiters();
   }
 
-  OBJ_GETTER(getWorkerNameUnlocked, KInt id) {
-    Worker* worker = nullptr;
-    ObjHolder nameHolder;
-    {
-      Locker locker(&lock_);
-      auto it = workers_.find(id);
-      if (it == workers_.end()) {
-        ThrowWorkerInvalidState();
+  bool pop(KNativePtr* message) {
+    uint64_t position = __atomic_load_n(&dequeuePosition_, __ATOMIC_RELAXED);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[position & mask_];
+      int64_t difference = static_cast<int64_t>(__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) - (position + 1));
+      if (difference == 0) {
+        if (__atomic_compare_exchange_n(
+            &dequeuePosition_, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+      } else if (difference < 0) {
+        // Empty, or the sender of the next message hasn't finished yet, it will notify us.
+        return false;
+      } else {
+        position = __atomic_load_n(&dequeuePosition_, __ATOMIC_RELAXED);
       }
-      DerefStablePointer(it->second->name(), nameHolder.slot());
     }
-    RETURN_OBJ(nameHolder.obj());
+    *message = cell->message;
+    __atomic_store_n(&cell->sequence, position + mask_ + 1, __ATOMIC_RELEASE);
+    atomicAdd(&size_, -1);
+    notifyWaiters();
+    return true;
   }
 
-  KBoolean waitForAnyFuture(KInt version, KInt millis) {
-    Locker locker(&lock_);
-    if (version != currentVersion_) return false;
+  void close() {
+    atomicSet(&closed_, 1);
+    notifyWaiters();
+  }
 
-    if (millis < 0) {
-      pthread_cond_wait(&cond_, &lock_);
-      return true;
-    }
+  bool closed() {
+    return atomicGet(&closed_) != 0;
+  }
 
-    uint64_t nsDelta = millis * 1000000LL;
-    WaitOnCondVar(&cond_, &lock_, nsDelta);
-    return true;
+  // Closed, and there are neither messages nor reservations left.
+  bool drained() {
+    return closed() && atomicGet(&size_) == 0;
   }
 
-  void signalAnyFuture() {
+  // Parks the worker until `ready` returns true. Returns false if the worker was terminated meanwhile.
+  template <typename Predicate>
+  bool waitFor(Worker* worker, Predicate ready) {
+    if (ready()) return true;
     {
       Locker locker(&lock_);
-      currentVersion_++;
+      waiters_.push_back(worker);
+      // Pairs with notifyWaiters(): either it sees the waiter, or we see the change.
+      atomicAdd(&waitersCount_, 1);
     }
-    pthread_cond_broadcast(&cond_);
+    bool result = worker->parkUntil(ready);
+    {
+      Locker locker(&lock_);
+      for (auto it = waiters_.begin(); it != waiters_.end(); ++it) {
+        if (*it == worker) {
+          waiters_.erase(it);
+          break;
+        }
+      }
+      atomicAdd(&waitersCount_, -1);
+    }
+    return result;
   }
 
-  KInt versionToken() {
+ private:
+  struct Cell {
+    // Position of the message, plus one if the message is there.
+    uint64_t sequence;
+    KNativePtr message;
+  };
+
+  void notifyWaiters() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (atomicGet(&waitersCount_) == 0) return;
     Locker locker(&lock_);
-    return currentVersion_;
+    for (auto* worker : waiters_) {
+      worker->wakeUp();
+    }
   }
 
-  // All those called with lock taken.
-  KInt nextWorkerId() { return currentWorkerId_++; }
-  KInt nextFutureId() { return currentFutureId_++; }
-
+  KInt id_;
+  KInt capacity_;
+  Cell* cells_;
+  uint64_t mask_;
+  uint64_t enqueuePosition_ = 0;
+  uint64_t dequeuePosition_ = 0;
+  // Guards waiters_.
+  pthread_mutex_t lock_;
+  KStdVector<Worker*> waiters_;
+  // Counters below are only accessed atomically.
+  KInt refCount_ = 1;
+  // Messages in the channel, and reserved for the messages being sent.
+  KInt size_ = 0;
+  KInt closed_ = 0;
+  KInt waitersCount_ = 0;
+};
+
+// Releases the channel reference acquired by State::findChannelUnlocked().
+class WorkerChannelReference {
+ public:
+  explicit WorkerChannelReference(WorkerChannel* channel) : channel_(channel) {}
+  ~WorkerChannelReference() {
+    channel_->release();
+  }
+
+  WorkerChannel* get() const { return channel_; }
+  WorkerChannel* operator->() const { return channel_; }
+
+ private:
+  WorkerChannel* channel_;
+};
+
+// Chase-Lev work-stealing deque, as described in "Correct and Efficient Work-Stealing for Weak Memory Models"
+// by Le, Pop, Cohen and Zappa Nardelli. Only the owning thread pushes and pops at the bottom end,
+// any other thread may steal from the top end.
+// Indices are word-sized, so that they are lock-free on 32-bit targets too. They are unsigned and wrap around,
+// so they are only compared through the signed distance between them.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  WorkStealingDeque() : top_(0), bottom_(0), array_(Array::create(kInitialCapacity)) {}
+
+  ~WorkStealingDeque() {
+    konanFreeMemory(array_);
+    for (auto* array : retired_) {
+      konanFreeMemory(array);
+    }
+  }
+
+  // Called by the owner only.
+  void push(T* item) {
+    Index bottom = __atomic_load_n(&bottom_, __ATOMIC_RELAXED);
+    Index top = __atomic_load_n(&top_, __ATOMIC_ACQUIRE);
+    Array* array = __atomic_load_n(&array_, __ATOMIC_RELAXED);
+    if (distance(top, bottom) >= static_cast<intptr_t>(array->capacity)) {
+      array = grow(array, top, bottom);
+    }
+    array->put(bottom, item);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+  }
+
+  // Called by the owner only.
+  T* pop() {
+    Index bottom = __atomic_load_n(&bottom_, __ATOMIC_RELAXED) - 1;
+    Array* array = __atomic_load_n(&array_, __ATOMIC_RELAXED);
+    __atomic_store_n(&bottom_, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    Index top = __atomic_load_n(&top_, __ATOMIC_RELAXED);
+    if (distance(top, bottom) < 0) {
+      __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+      return nullptr;
+    }
+    T* result = array->get(bottom);
+    if (top == bottom) {
+      // The last item, race with thieves for it.
+      if (!__atomic_compare_exchange_n(&top_, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        result = nullptr;
+      __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return result;
+  }
+
+  // May be called by any thread. Returns nullptr if the deque is empty or the race for the item was lost.
+  T* steal() {
+    Index top = __atomic_load_n(&top_, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    Index bottom = __atomic_load_n(&bottom_, __ATOMIC_ACQUIRE);
+    if (distance(top, bottom) <= 0) return nullptr;
+    Array* array = __atomic_load_n(&array_, __ATOMIC_ACQUIRE);
+    T* result = array->get(top);
+    if (!__atomic_compare_exchange_n(&top_, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+      return nullptr;
+    return result;
+  }
+
+ private:
+  using Index = uintptr_t;
+
+  static intptr_t distance(Index from, Index to) {
+    return static_cast<intptr_t>(to - from);
+  }
+
+  struct Array {
+    // Always a power of two.
+    size_t capacity;
+    T* items[];
+
+    static Array* create(size_t capacity) {
+      Array* result = reinterpret_cast<Array*>(konanAllocMemory(sizeof(Array) + capacity * sizeof(T*)));
+      RuntimeCheck(result != nullptr, "Cannot alloc memory");
+      result->capacity = capacity;
+      return result;
+    }
+
+    T* get(Index index) {
+      return __atomic_load_n(&items[index & (capacity - 1)], __ATOMIC_RELAXED);
+    }
+
+    void put(Index index, T* item) {
+      __atomic_store_n(&items[index & (capacity - 1)], item, __ATOMIC_RELAXED);
+    }
+  };
+
+  Array* grow(Array* array, Index top, Index bottom) {
+    Array* result = Array::create(array->capacity * 2);
+    for (Index index = top; index != bottom; index++) {
+      result->put(index, array->get(index));
+    }
+    // Thieves may still read from the old array, so it is only freed with the deque.
+    retired_.push_back(array);
+    __atomic_store_n(&array_, result, __ATOMIC_RELEASE);
+    return result;
+  }
+
+  static constexpr size_t kInitialCapacity = 64;
+
+  Index top_;
+  Index bottom_;
+  Array* array_;
+  KStdVector<Array*> retired_;
+};
+
+// Fixed set of worker threads executing jobs submitted to the pool. Every thread has its own deque
+// of jobs, jobs submitted from a pool thread go to its deque, other submissions go to the shared
+// injection queue. Threads out of jobs steal from the deques of other threads, and only park when
+// there are no pending jobs at all.
+class WorkerPool {
+ public:
+  struct Thread {
+    Thread(WorkerPool* pool, KInt index) : pool(pool), index(index) {}
+
+    WorkerPool* pool;
+    KInt index;
+    Worker* worker = nullptr;
+    KInt nextVictim = 0;
+    WorkStealingDeque<Job> deque;
+  };
+
+  WorkerPool(KInt id, KInt size, bool errorReporting)
+      : id_(id),
+        errorReporting_(errorReporting) {
+    pthread_mutex_init(&lock_, nullptr);
+    pthread_cond_init(&cond_, nullptr);
+    // All threads are created upfront, as thieves iterate over them without synchronization.
+    for (KInt index = 0; index < size; index++) {
+      threads_.push_back(konanConstructInstance<Thread>(this, index));
+    }
+    alive_ = size;
+  }
+
+  ~WorkerPool();
+
+  void start();
+
+  void run(Thread* thread);
+
+  void submit(Job* job);
+
+  void submitBatch(FutureGroup* group);
+
+  void requestTermination(Future* future, bool processScheduledJobs);
+
+  // Jobs may be submitted from any thread until termination is requested, and only from the pool threads after that.
+  bool acceptsJobs();
+
+  bool terminating() { return atomicGet(&terminating_); }
+
+  void wakeUpAll();
+
+  KInt id() const { return id_; }
+
+ private:
+  Job* takeJob(Thread* thread);
+
+  void park(KInt wakeUps, KLong timeoutMicroseconds);
+
+  void notifyOne();
+
+  KInt id_;
+  bool errorReporting_;
+  KStdVector<Thread*> threads_;
+  // Jobs submitted from outside of the pool, guarded by lock_.
+  KStdDeque<Job*> injected_;
+  // Lock and condition for parking threads.
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  // Counters below are only accessed atomically.
+  // Number of jobs submitted, but not taken by any thread yet.
+  KInt pending_ = 0;
+  // Number of jobs being executed.
+  KInt running_ = 0;
+  // Number of parked threads.
+  KInt sleeping_ = 0;
+  // Size of injected_.
+  KInt injectedSize_ = 0;
+  // Incremented on every event the parked threads must check, such as termination request.
+  KInt wakeUps_ = 0;
+  // Number of threads which have not exited yet.
+  KInt alive_ = 0;
+  KBoolean terminating_ = false;
+  KBoolean cancelling_ = false;
+  Future* terminationFuture_ = nullptr;
+};
+
+// Pool thread the current thread is, if any.
+THREAD_LOCAL_VARIABLE WorkerPool::Thread* g_poolThread = nullptr;
+
+// Map split into independently locked shards, so that operations with different keys rarely contend.
+template <typename Value>
+class ShardedMap {
+ public:
+  struct Shard {
+    Shard() {
+      pthread_mutex_init(&lock, nullptr);
+    }
+
+    ~Shard() {
+      pthread_mutex_destroy(&lock);
+    }
+
+    pthread_mutex_t lock;
+    KStdUnorderedMap<KInt, Value> map;
+  };
+
+  Shard& shard(KInt key) {
+    return shards_[static_cast<uint32_t>(key) % kShardCount];
+  }
+
+  template <typename F>
+  void forEachShard(F function) {
+    for (auto& shard : shards_) {
+      function(shard);
+    }
+  }
+
+ private:
+  static constexpr int kShardCount = 16;
+
+  Shard shards_[kShardCount];
+};
+
+class State {
+ public:
+  State() {
+    pthread_mutex_init(&lock_, nullptr);
+    pthread_cond_init(&cond_, nullptr);
+
+    currentWorkerId_ = 0;
+    currentPoolId_ = 0;
+    currentFutureId_ = 0;
+    currentGroupId_ = 0;
+    currentChannelId_ = 0;
+    currentVersion_ = 0;
+    anyFutureWaiters_ = 0;
+  }
+
+  ~State() {
+    // TODO: some sanity check here?
+    pthread_mutex_destroy(&lock_);
+    pthread_cond_destroy(&cond_);
+  }
+
+  Worker* addWorkerUnlocked(bool errorReporting, KRef customName, WorkerKind kind) {
+    Worker* worker = konanConstructInstance<Worker>(nextWorkerId(), errorReporting, customName, kind);
+    if (worker == nullptr) return nullptr;
+    {
+      auto& shard = workers_.shard(worker->id());
+      Locker locker(&shard.lock);
+      shard.map[worker->id()] = worker;
+    }
+    GC_RegisterWorker(worker);
+    return worker;
+  }
+
+  void removeWorkerUnlocked(KInt id) {
+    auto& shard = workers_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) return;
+    Worker* worker = it->second;
+    if (worker->kind() != WorkerKind::kOther) {
+      Locker terminatingLocker(&lock_);
+      terminating_native_workers_[id] = worker->thread();
+    }
+    shard.map.erase(it);
+  }
+
+  void destroyWorkerUnlocked(Worker* worker) {
+    {
+      auto id = worker->id();
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.map.find(id);
+      if (it != shard.map.end()) {
+        shard.map.erase(it);
+      }
+    }
+    GC_UnregisterWorker(worker);
+    konanDestructInstance(worker);
+  }
+
+  Future* addJobToWorkerUnlocked(
+      KInt id, KNativePtr jobFunction, KNativePtr jobArgument, bool toFront, KInt transferMode) {
+    Future* future = nullptr;
+    Worker* worker = nullptr;
+    // Worker is only destroyed after removal from the map, so keep the lock until the job is put.
+    auto& shard = workers_.shard(id);
+    Locker locker(&shard.lock);
+
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) return nullptr;
+    worker = it->second;
+    // Pool threads are only terminated together with their pool.
+    if (jobFunction == nullptr && worker->kind() == WorkerKind::kPool) return nullptr;
+
+    future = addFutureUnlocked();
+
+    Job job;
+    if (jobFunction == nullptr) {
+      job.kind = JOB_TERMINATE;
+      job.terminationRequest.future = future;
+      job.terminationRequest.waitDelayed = !toFront;
+    } else {
+      job.kind = JOB_REGULAR;
+      job.regularJob.function = reinterpret_cast<KRef (*)(KRef, ObjHeader**)>(jobFunction);
+      job.regularJob.argument = jobArgument;
+      job.regularJob.future = future;
+      job.regularJob.transferMode = transferMode;
+    }
+
+    worker->putJob(job, toFront);
+
+    return future;
+  }
+
+  WorkerPool* addPoolUnlocked(KInt size, bool errorReporting) {
+    WorkerPool* pool = konanConstructInstance<WorkerPool>(nextPoolId(), size, errorReporting);
+    auto& shard = pools_.shard(pool->id());
+    Locker locker(&shard.lock);
+    shard.map[pool->id()] = pool;
+    return pool;
+  }
+
+  Future* addJobToPoolUnlocked(KInt id, KNativePtr jobArgument, KInt transferMode) {
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end() || !it->second->acceptsJobs()) return nullptr;
+
+    Future* future = addFutureUnlocked();
+
+    Job* job = konanConstructInstance<Job>();
+    job->kind = JOB_REGULAR;
+    job->regularJob.function = WorkerLaunchpad;
+    job->regularJob.argument = jobArgument;
+    job->regularJob.future = future;
+    job->regularJob.transferMode = transferMode;
+    it->second->submit(job);
+
+    return future;
+  }
+
+  Future* terminatePoolUnlocked(KInt id, bool processScheduledJobs) {
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end() || it->second->terminating()) return nullptr;
+    WorkerPool* pool = it->second;
+    // The pool stays in the map, so that running jobs could still submit to it,
+    // until the last exiting thread removes and destroys it.
+
+    Future* future = addFutureUnlocked();
+    pool->requestTermination(future, processScheduledJobs);
+    return future;
+  }
+
+  // Called by the last exiting thread of the pool.
+  void removePoolUnlocked(KInt id) {
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    shard.map.erase(id);
+  }
+
+  FutureGroup* addGroupUnlocked(KInt size, KInt transferMode) {
+    FutureGroup* group = konanConstructInstance<FutureGroup>(nextGroupId(), size, transferMode);
+    auto& shard = groups_.shard(group->id());
+    Locker locker(&shard.lock);
+    shard.map[group->id()] = group;
+    return group;
+  }
+
+  // Called once the group is consumed, or if it couldn't be submitted.
+  void removeGroupUnlocked(FutureGroup* group) {
+    {
+      auto& shard = groups_.shard(group->id());
+      Locker locker(&shard.lock);
+      shard.map.erase(group->id());
+    }
+    group->release();
+  }
+
+  // Returns the retained group or nullptr.
+  FutureGroup* findGroupUnlocked(KInt id) {
+    auto& shard = groups_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) return nullptr;
+    it->second->retain();
+    return it->second;
+  }
+
+  WorkerChannel* addChannelUnlocked(KInt capacity) {
+    WorkerChannel* channel = konanConstructInstance<WorkerChannel>(nextChannelId(), capacity);
+    auto& shard = channels_.shard(channel->id());
+    Locker locker(&shard.lock);
+    shard.map[channel->id()] = channel;
+    return channel;
+  }
+
+  // Called once the channel is closed and drained, may be called several times.
+  void removeChannelUnlocked(WorkerChannel* channel) {
+    bool removed = false;
+    {
+      auto& shard = channels_.shard(channel->id());
+      Locker locker(&shard.lock);
+      removed = shard.map.erase(channel->id()) != 0;
+    }
+    if (removed) channel->release();
+  }
+
+  // Returns the retained channel or nullptr.
+  WorkerChannel* findChannelUnlocked(KInt id) {
+    auto& shard = channels_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) return nullptr;
+    it->second->retain();
+    return it->second;
+  }
+
+  bool addBatchToWorkerUnlocked(KInt id, FutureGroup* group) {
+    auto& shard = workers_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) return false;
+
+    group->retain();
+    Job job;
+    job.kind = JOB_BATCH;
+    job.batch.group = group;
+    job.batch.first = 0;
+    job.batch.count = group->size();
+    it->second->putJob(job, false);
+    return true;
+  }
+
+  bool addBatchToPoolUnlocked(KInt id, FutureGroup* group) {
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end() || !it->second->acceptsJobs()) return false;
+
+    it->second->submitBatch(group);
+    return true;
+  }
+
+  OBJ_GETTER(consumeFutureGroupElementUnlocked, KInt id, KInt index) {
+    FutureGroup* found = findGroupUnlocked(id);
+    if (found == nullptr) ThrowWorkerInvalidState();
+    FutureGroupReference group(found);
+    if (index < 0 || index >= group->size()) ThrowArrayIndexOutOfBoundsException();
+    bool last = false;
+    KInt state = group->consume(index, OBJ_RESULT, &last);
+    if (last) removeGroupUnlocked(found);
+    // Exception of the failed job belongs to the heap of the worker that ran it, and was reported there.
+    if (state != COMPUTED) ThrowIllegalStateException();
+    return *OBJ_RESULT;
+  }
+
+  // Sets `handle` to -1 for the jobs queued right away, as those cannot be cancelled.
+  bool executeJobAfterInWorkerUnlocked(KInt id, KRef operation, KLong afterMicroseconds, KLong* handle) {
+    Worker* worker = nullptr;
+    auto& shard = workers_.shard(id);
+    Locker locker(&shard.lock);
+
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) {
+      return false;
+    }
+    worker = it->second;
+    if (afterMicroseconds == 0) {
+      Job job;
+      job.kind = JOB_EXECUTE_AFTER;
+      job.executeAfter.operation = CreateStablePointer(operation);
+      worker->putJob(job, false);
+      *handle = -1;
+    } else {
+      *handle = worker->putDelayedJob(CreateStablePointer(operation), afterMicroseconds);
+    }
+    return true;
+  }
+
+  bool cancelJobAfterInWorkerUnlocked(KInt id, KLong handle) {
+    auto& shard = workers_.shard(id);
+    Locker locker(&shard.lock);
+
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) {
+      return false;
+    }
+    return it->second->cancelDelayedJob(handle);
+  }
+
+  // Returns `true` if something was indeed processed.
+  bool processQueueUnlocked(KInt id) {
+    // Can only process queue of the current worker.
+    if (::g_worker == nullptr || id != ::g_worker->id()) ThrowWorkerInvalidState();
+    JobKind kind = ::g_worker->processQueueElement(false);
+    return kind != JOB_NONE && kind != JOB_TERMINATE;
+  }
+
+  bool parkUnlocked(KInt id, KLong timeoutMicroseconds, KBoolean process) {
+      // Can only park current worker.
+      if (::g_worker == nullptr || id != ::g_worker->id()) ThrowWorkerInvalidState();
+      return ::g_worker->park(timeoutMicroseconds, process);
+  }
+
+  KInt stateOfFutureUnlocked(KInt id) {
+    auto& shard = futures_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.map.find(id);
+    if (it == shard.map.end()) return INVALID;
+    return it->second->state();
+  }
+
+  OBJ_GETTER(consumeFutureUnlocked, KInt id) {
+    Future* future = nullptr;
+    auto& shard = futures_.shard(id);
+    {
+      Locker locker(&shard.lock);
+      auto it = shard.map.find(id);
+      if (it == shard.map.end()) ThrowWorkerInvalidState();
+      future = it->second;
+
+    }
+
+    KRef result = future->consumeResultUnlocked(OBJ_RESULT);
+
+    {
+       Locker locker(&shard.lock);
+       auto it = shard.map.find(id);
+       if (it != shard.map.end()) {
+         shard.map.erase(it);
+         konanDestructInstance(future);
+       }
+    }
+
+    return result;
+  }
+
+  OBJ_GETTER(getWorkerNameUnlocked, KInt id) {
+    ObjHolder nameHolder;
+    {
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.map.find(id);
+      if (it == shard.map.end()) {
+        ThrowWorkerInvalidState();
+      }
+      DerefStablePointer(it->second->name(), nameHolder.slot());
+    }
+    RETURN_OBJ(nameHolder.obj());
+  }
+
+  KBoolean waitForAnyFuture(KInt version, KInt millis) {
+    Locker locker(&lock_);
+    // Pairs with signalAnyFuture(): either it sees the waiter, or we see the new version.
+    atomicAdd(&anyFutureWaiters_, 1);
+    if (version != atomicGet(&currentVersion_)) {
+      atomicAdd(&anyFutureWaiters_, -1);
+      return false;
+    }
+
+    if (millis < 0) {
+      pthread_cond_wait(&cond_, &lock_);
+    } else {
+      uint64_t nsDelta = millis * 1000000LL;
+      WaitOnCondVar(&cond_, &lock_, nsDelta);
+    }
+    atomicAdd(&anyFutureWaiters_, -1);
+    return true;
+  }
+
+  void signalAnyFuture() {
+    atomicAdd(&currentVersion_, 1);
+    // Most of the futures are consumed without waiting for any of them, so avoid the lock if possible.
+    if (atomicGet(&anyFutureWaiters_) == 0) return;
+    Locker locker(&lock_);
+    pthread_cond_broadcast(&cond_);
+  }
+
+  KInt versionToken() {
+    return atomicGet(&currentVersion_);
+  }
+
+  KInt nextWorkerId() { return atomicAdd(&currentWorkerId_, 1); }
+  KInt nextPoolId() { return atomicAdd(&currentPoolId_, 1); }
+  KInt nextFutureId() { return atomicAdd(&currentFutureId_, 1); }
+  KInt nextGroupId() { return atomicAdd(&currentGroupId_, 1); }
+  KInt nextChannelId() { return atomicAdd(&currentChannelId_, 1); }
+
   void destroyWorkerThreadDataUnlocked(KInt id) {
     Locker locker(&lock_);
     auto it = terminating_native_workers_.find(id);
@@ -461,12 +1599,12 @@ class State {
   }
 
   void waitNativeWorkersTerminationUnlocked() {
+    checkNativeWorkersLeakUnlocked();
+
     std::vector<pthread_t> threadsToWait;
     {
       Locker locker(&lock_);
 
-      checkNativeWorkersLeakLocked();
-
       for (auto& kvp : terminating_native_workers_) {
         RuntimeAssert(!pthread_equal(kvp.second, pthread_self()), "Native worker is joining with itself");
         threadsToWait.push_back(kvp.second);
@@ -479,14 +1617,17 @@ class State {
     }
   }
 
-  void checkNativeWorkersLeakLocked() {
+  void checkNativeWorkersLeakUnlocked() {
     size_t remainingNativeWorkers = 0;
-    for (const auto& kvp : workers_) {
-      Worker* worker = kvp.second;
-      if (worker->kind() == WorkerKind::kNative) {
-        ++remainingNativeWorkers;
+    workers_.forEachShard([&remainingNativeWorkers](ShardedMap<Worker*>::Shard& shard) {
+      Locker locker(&shard.lock);
+      for (const auto& kvp : shard.map) {
+        Worker* worker = kvp.second;
+        if (worker->kind() != WorkerKind::kOther) {
+          ++remainingNativeWorkers;
+        }
       }
-    }
+    });
 
     if (remainingNativeWorkers != 0) {
       konan::consoleErrorf(
@@ -498,14 +1639,32 @@ class State {
   }
 
  private:
+  Future* addFutureUnlocked() {
+    Future* future = konanConstructInstance<Future>(nextFutureId());
+    auto& shard = futures_.shard(future->id());
+    Locker locker(&shard.lock);
+    shard.map[future->id()] = future;
+    return future;
+  }
+
+  // Guards terminating_native_workers_ and waiting for any future.
   pthread_mutex_t lock_;
   pthread_cond_t cond_;
-  KStdUnorderedMap<KInt, Future*> futures_;
-  KStdUnorderedMap<KInt, Worker*> workers_;
+  // Lock order: a worker or a pool shard, then a future shard, then lock_.
+  ShardedMap<Future*> futures_;
+  ShardedMap<Worker*> workers_;
+  ShardedMap<WorkerPool*> pools_;
+  ShardedMap<FutureGroup*> groups_;
+  ShardedMap<WorkerChannel*> channels_;
   KStdUnorderedMap<KInt, pthread_t> terminating_native_workers_;
+  // Counters below are only accessed atomically.
   KInt currentWorkerId_;
+  KInt currentPoolId_;
   KInt currentFutureId_;
+  KInt currentGroupId_;
+  KInt currentChannelId_;
   KInt currentVersion_;
+  KInt anyFutureWaiters_;
 };
 
 State* theState() {
@@ -549,141 +1708,364 @@ void Future::cancelUnlocked() {
   theState()->signalAnyFuture();
 }
 
-// Defined in RuntimeUtils.kt.
-extern "C" void ReportUnhandledException(KRef e);
+// Defined in RuntimeUtils.kt.
+extern "C" void ReportUnhandledException(KRef e);
+
+KInt startWorker(KBoolean errorReporting, KRef customName) {
+  Worker* worker = theState()->addWorkerUnlocked(errorReporting != 0, customName, WorkerKind::kNative);
+  if (worker == nullptr) return -1;
+  worker->startEventLoop();
+  return worker->id();
+}
+
+KInt currentWorker() {
+  if (g_worker == nullptr) ThrowWorkerInvalidState();
+  return ::g_worker->id();
+}
+
+KInt execute(KInt id, KInt transferMode, KRef producer, KNativePtr jobFunction) {
+  Job job;
+  ObjHolder holder;
+  WorkerLaunchpad(producer, holder.slot());
+  KNativePtr jobArgument = transfer(&holder, transferMode);
+  Future* future = theState()->addJobToWorkerUnlocked(id, jobFunction, jobArgument, false, transferMode);
+  if (future == nullptr) ThrowWorkerInvalidState();
+  return future->id();
+}
+
+KLong executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
+  KLong handle;
+  if (!theState()->executeJobAfterInWorkerUnlocked(id, job, afterMicroseconds, &handle))
+    ThrowWorkerInvalidState();
+  return handle;
+}
+
+KBoolean cancelDelayedJob(KInt id, KLong handle) {
+  return theState()->cancelJobAfterInWorkerUnlocked(id, handle);
+}
+
+KBoolean processQueue(KInt id) {
+   return theState()->processQueueUnlocked(id);
+}
+
+KBoolean park(KInt id, KLong timeoutMicroseconds, KBoolean process) {
+   return theState()->parkUnlocked(id, timeoutMicroseconds, process);
+}
+
+KInt stateOfFuture(KInt id) {
+  return theState()->stateOfFutureUnlocked(id);
+}
+
+OBJ_GETTER(consumeFuture, KInt id) {
+  RETURN_RESULT_OF(theState()->consumeFutureUnlocked, id);
+}
+
+OBJ_GETTER(getWorkerName, KInt id) {
+  RETURN_RESULT_OF(theState()->getWorkerNameUnlocked, id);
+}
+
+KInt requestTermination(KInt id, KBoolean processScheduledJobs) {
+  Future* future = theState()->addJobToWorkerUnlocked(
+      id, nullptr, nullptr, /* toFront = */ !processScheduledJobs, UNCHECKED);
+  if (future == nullptr) ThrowWorkerInvalidState();
+  return future->id();
+}
+
+KBoolean waitForAnyFuture(KInt version, KInt millis) {
+  return theState()->waitForAnyFuture(version, millis);
+}
+
+KInt versionToken() {
+  return theState()->versionToken();
+}
+
+OBJ_GETTER(attachObjectGraphInternal, KNativePtr stable) {
+  RETURN_RESULT_OF(AdoptStablePointer, stable);
+}
+
+KNativePtr detachObjectGraphInternal(KInt transferMode, KRef producer) {
+   ObjHolder result;
+   WorkerLaunchpad(producer, result.slot());
+   if (result.obj() != nullptr) {
+     return transfer(&result, transferMode);
+   } else {
+     return nullptr;
+   }
+}
+
+KInt startWorkerPool(KInt size, KBoolean errorReporting) {
+  WorkerPool* pool = theState()->addPoolUnlocked(size, errorReporting != 0);
+  pool->start();
+  return pool->id();
+}
+
+KInt executeInWorkerPool(KInt id, KInt transferMode, KRef producer) {
+  ObjHolder holder;
+  WorkerLaunchpad(producer, holder.slot());
+  KNativePtr jobArgument = transfer(&holder, transferMode);
+  Future* future = theState()->addJobToPoolUnlocked(id, jobArgument, transferMode);
+  if (future == nullptr) {
+    DisposeStablePointer(jobArgument);
+    ThrowWorkerInvalidState();
+  }
+  return future->id();
+}
+
+KInt requestWorkerPoolTermination(KInt id, KBoolean processScheduledJobs) {
+  Future* future = theState()->terminatePoolUnlocked(id, processScheduledJobs != 0);
+  if (future == nullptr) ThrowWorkerInvalidState();
+  return future->id();
+}
+
+// Runs producer for every element of the batch, and transfers its results to the new group.
+FutureGroup* produceBatch(KInt transferMode, KInt count, KRef producer) {
+  FutureGroup* group = theState()->addGroupUnlocked(count, transferMode);
+  try {
+    for (KInt index = 0; index < count; index++) {
+      ObjHolder holder;
+      WorkerBatchLaunchpad(producer, index, holder.slot());
+      group->setArgument(index, transfer(&holder, transferMode));
+    }
+  } catch (ExceptionObjHolder& e) {
+    theState()->removeGroupUnlocked(group);
+    throw;
+  }
+  return group;
+}
+
+KInt executeBatch(KInt id, KInt transferMode, KInt count, KRef producer) {
+  FutureGroup* group = produceBatch(transferMode, count, producer);
+  KInt groupId = group->id();
+  if (!theState()->addBatchToWorkerUnlocked(id, group)) {
+    theState()->removeGroupUnlocked(group);
+    ThrowWorkerInvalidState();
+  }
+  return groupId;
+}
+
+KInt executeBatchInWorkerPool(KInt id, KInt transferMode, KInt count, KRef producer) {
+  FutureGroup* group = produceBatch(transferMode, count, producer);
+  KInt groupId = group->id();
+  if (!theState()->addBatchToPoolUnlocked(id, group)) {
+    theState()->removeGroupUnlocked(group);
+    ThrowWorkerInvalidState();
+  }
+  return groupId;
+}
+
+KInt sizeOfFutureGroup(KInt id) {
+  FutureGroup* found = theState()->findGroupUnlocked(id);
+  if (found == nullptr) ThrowWorkerInvalidState();
+  FutureGroupReference group(found);
+  return group->size();
+}
+
+KInt stateOfFutureGroupElement(KInt id, KInt index) {
+  FutureGroup* found = theState()->findGroupUnlocked(id);
+  if (found == nullptr) return INVALID;
+  FutureGroupReference group(found);
+  if (index < 0 || index >= group->size()) ThrowArrayIndexOutOfBoundsException();
+  return group->state(index);
+}
+
+KBoolean awaitAllOfFutureGroup(KInt id, KInt millis) {
+  FutureGroup* found = theState()->findGroupUnlocked(id);
+  // Consumed completely.
+  if (found == nullptr) return true;
+  FutureGroupReference group(found);
+  return group->awaitAll(millis);
+}
+
+KInt awaitAnyOfFutureGroup(KInt id, KInt millis) {
+  FutureGroup* found = theState()->findGroupUnlocked(id);
+  if (found == nullptr) return -1;
+  FutureGroupReference group(found);
+  return group->awaitAny(millis);
+}
+
+OBJ_GETTER(consumeFutureGroupElement, KInt id, KInt index) {
+  RETURN_RESULT_OF(theState()->consumeFutureGroupElementUnlocked, id, index);
+}
+
+KInt createChannel(KInt capacity) {
+  return theState()->addChannelUnlocked(capacity)->id();
+}
+
+KBoolean sendToChannel(KInt id, KInt transferMode, KRef producer, KBoolean blocking) {
+  WorkerChannel* found = theState()->findChannelUnlocked(id);
+  // Closed and drained already.
+  if (found == nullptr) ThrowWorkerInvalidState();
+  WorkerChannelReference channel(found);
+  if (channel->closed()) ThrowWorkerInvalidState();
+  bool reserved = channel->reserve();
+  if (!reserved) {
+    if (!blocking) return false;
+    channel->waitFor(::g_worker, [&channel, &reserved] {
+      return channel->closed() || (reserved = channel->reserve());
+    });
+    if (!reserved) ThrowWorkerInvalidState();
+  }
+  // Producer only runs once there is room for its result.
+  KNativePtr message = nullptr;
+  try {
+    ObjHolder holder;
+    WorkerLaunchpad(producer, holder.slot());
+    message = transfer(&holder, transferMode, true);
+  } catch (ExceptionObjHolder& e) {
+    channel->cancelReservation();
+    if (channel->drained()) theState()->removeChannelUnlocked(channel.get());
+    throw;
+  }
+  channel->push(message);
+  return true;
+}
+
+OBJ_GETTER(receiveFromChannel, KInt id, KBoolean blocking) {
+  WorkerChannel* found = theState()->findChannelUnlocked(id);
+  if (found == nullptr) {
+    if (blocking) ThrowWorkerInvalidState();
+    RETURN_OBJ(nullptr);
+  }
+  WorkerChannelReference channel(found);
+  KNativePtr message = nullptr;
+  bool received = channel->pop(&message);
+  if (!received && blocking) {
+    channel->waitFor(::g_worker, [&channel, &message, &received] {
+      return (received = channel->pop(&message)) || channel->drained();
+    });
+  }
+  if (channel->drained()) theState()->removeChannelUnlocked(channel.get());
+  if (!received) {
+    if (blocking) ThrowWorkerInvalidState();
+    RETURN_OBJ(nullptr);
+  }
+  RETURN_RESULT_OF(AdoptStablePointer, message);
+}
+
+void closeChannel(KInt id) {
+  WorkerChannel* found = theState()->findChannelUnlocked(id);
+  if (found == nullptr) return;
+  WorkerChannelReference channel(found);
+  channel->close();
+  if (channel->drained()) theState()->removeChannelUnlocked(channel.get());
+}
+
+#else
 
 KInt startWorker(KBoolean errorReporting, KRef customName) {
-  Worker* worker = theState()->addWorkerUnlocked(errorReporting != 0, customName, WorkerKind::kNative);
-  if (worker == nullptr) return -1;
-  worker->startEventLoop();
-  return worker->id();
+  ThrowWorkerUnsupported();
 }
 
-KInt currentWorker() {
-  if (g_worker == nullptr) ThrowWorkerInvalidState();
-  return ::g_worker->id();
+KInt stateOfFuture(KInt id) {
+  ThrowWorkerUnsupported();
 }
 
 KInt execute(KInt id, KInt transferMode, KRef producer, KNativePtr jobFunction) {
-  Job job;
-  ObjHolder holder;
-  WorkerLaunchpad(producer, holder.slot());
-  KNativePtr jobArgument = transfer(&holder, transferMode);
-  Future* future = theState()->addJobToWorkerUnlocked(id, jobFunction, jobArgument, false, transferMode);
-  if (future == nullptr) ThrowWorkerInvalidState();
-  return future->id();
+  ThrowWorkerUnsupported();
 }
 
-void executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
-  if (!theState()->executeJobAfterInWorkerUnlocked(id, job, afterMicroseconds))
-    ThrowWorkerInvalidState();
+KLong executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
+  ThrowWorkerUnsupported();
+}
+
+KBoolean cancelDelayedJob(KInt id, KLong handle) {
+  ThrowWorkerUnsupported();
 }
 
 KBoolean processQueue(KInt id) {
-   return theState()->processQueueUnlocked(id);
+  ThrowWorkerUnsupported();
 }
 
 KBoolean park(KInt id, KLong timeoutMicroseconds, KBoolean process) {
-   return theState()->parkUnlocked(id, timeoutMicroseconds, process);
+   ThrowWorkerUnsupported();
 }
 
-KInt stateOfFuture(KInt id) {
-  return theState()->stateOfFutureUnlocked(id);
+KInt currentWorker() {
+  ThrowWorkerUnsupported();
 }
 
 OBJ_GETTER(consumeFuture, KInt id) {
-  RETURN_RESULT_OF(theState()->consumeFutureUnlocked, id);
+  ThrowWorkerUnsupported();
 }
 
 OBJ_GETTER(getWorkerName, KInt id) {
-  RETURN_RESULT_OF(theState()->getWorkerNameUnlocked, id);
+  ThrowWorkerUnsupported();
 }
 
 KInt requestTermination(KInt id, KBoolean processScheduledJobs) {
-  Future* future = theState()->addJobToWorkerUnlocked(
-      id, nullptr, nullptr, /* toFront = */ !processScheduledJobs, UNCHECKED);
-  if (future == nullptr) ThrowWorkerInvalidState();
-  return future->id();
+  ThrowWorkerUnsupported();
 }
 
-KBoolean waitForAnyFuture(KInt version, KInt millis) {
-  return theState()->waitForAnyFuture(version, millis);
+KBoolean waitForAnyFuture(KInt versionToken, KInt millis) {
+  ThrowWorkerUnsupported();
 }
 
 KInt versionToken() {
-  return theState()->versionToken();
+  ThrowWorkerUnsupported();
 }
 
 OBJ_GETTER(attachObjectGraphInternal, KNativePtr stable) {
-  RETURN_RESULT_OF(AdoptStablePointer, stable);
+  ThrowWorkerUnsupported();
 }
 
 KNativePtr detachObjectGraphInternal(KInt transferMode, KRef producer) {
-   ObjHolder result;
-   WorkerLaunchpad(producer, result.slot());
-   if (result.obj() != nullptr) {
-     return transfer(&result, transferMode);
-   } else {
-     return nullptr;
-   }
+   ThrowWorkerUnsupported();
 }
 
-#else
-
-KInt startWorker(KBoolean errorReporting, KRef customName) {
+KInt startWorkerPool(KInt size, KBoolean errorReporting) {
   ThrowWorkerUnsupported();
 }
 
-KInt stateOfFuture(KInt id) {
+KInt executeInWorkerPool(KInt id, KInt transferMode, KRef producer) {
   ThrowWorkerUnsupported();
 }
 
-KInt execute(KInt id, KInt transferMode, KRef producer, KNativePtr jobFunction) {
+KInt requestWorkerPoolTermination(KInt id, KBoolean processScheduledJobs) {
   ThrowWorkerUnsupported();
 }
 
-void executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
+KInt executeBatch(KInt id, KInt transferMode, KInt count, KRef producer) {
   ThrowWorkerUnsupported();
 }
 
-KBoolean processQueue(KInt id) {
+KInt executeBatchInWorkerPool(KInt id, KInt transferMode, KInt count, KRef producer) {
   ThrowWorkerUnsupported();
 }
 
-KBoolean park(KInt id, KLong timeoutMicroseconds, KBoolean process) {
-   ThrowWorkerUnsupported();
+KInt sizeOfFutureGroup(KInt id) {
+  ThrowWorkerUnsupported();
 }
 
-KInt currentWorker() {
+KInt stateOfFutureGroupElement(KInt id, KInt index) {
   ThrowWorkerUnsupported();
 }
 
-OBJ_GETTER(consumeFuture, KInt id) {
+KBoolean awaitAllOfFutureGroup(KInt id, KInt millis) {
   ThrowWorkerUnsupported();
 }
 
-OBJ_GETTER(getWorkerName, KInt id) {
+KInt awaitAnyOfFutureGroup(KInt id, KInt millis) {
   ThrowWorkerUnsupported();
 }
 
-KInt requestTermination(KInt id, KBoolean processScheduledJobs) {
+OBJ_GETTER(consumeFutureGroupElement, KInt id, KInt index) {
   ThrowWorkerUnsupported();
 }
 
-KBoolean waitForAnyFuture(KInt versionToken, KInt millis) {
+KInt createChannel(KInt capacity) {
   ThrowWorkerUnsupported();
 }
 
-KInt versionToken() {
+KBoolean sendToChannel(KInt id, KInt transferMode, KRef producer, KBoolean blocking) {
   ThrowWorkerUnsupported();
 }
 
-OBJ_GETTER(attachObjectGraphInternal, KNativePtr stable) {
+OBJ_GETTER(receiveFromChannel, KInt id, KBoolean blocking) {
   ThrowWorkerUnsupported();
 }
 
-KNativePtr detachObjectGraphInternal(KInt transferMode, KRef producer) {
-   ThrowWorkerUnsupported();
+void closeChannel(KInt id) {
+  ThrowWorkerUnsupported();
 }
 
 #endif  // WITH_WORKERS
@@ -746,13 +2128,36 @@ void WorkerResume(Worker* worker) {
 
 #if WITH_WORKERS
 
+namespace {
+
+// Disposes arguments of a job which won't be executed, and notifies its future or group.
+void cancelJob(const Job& job) {
+  switch (job.kind) {
+    case JOB_REGULAR:
+      DisposeStablePointer(job.regularJob.argument);
+      job.regularJob.future->cancelUnlocked();
+      break;
+    case JOB_BATCH:
+      for (KInt index = job.batch.first; index < job.batch.first + job.batch.count; index++) {
+        job.batch.group->cancel(index);
+      }
+      job.batch.group->release();
+      break;
+    default:
+      RuntimeCheck(false, "Only jobs with results can be cancelled");
+  }
+}
+
+}  // namespace
+
 Worker::~Worker() {
   // Cleanup jobs in the queue.
-  for (auto job : queue_) {
+  Job job;
+  while (popJob(&job)) {
     switch (job.kind) {
       case JOB_REGULAR:
-        DisposeStablePointer(job.regularJob.argument);
-        job.regularJob.future->cancelUnlocked();
+      case JOB_BATCH:
+        cancelJob(job);
         break;
       case JOB_EXECUTE_AFTER: {
         // TODO: what do we do here? Shall we execute them?
@@ -771,15 +2176,12 @@ Worker::~Worker() {
     }
   }
 
-  for (auto job : delayed_) {
-    RuntimeAssert(job.kind == JOB_EXECUTE_AFTER, "Must be delayed");
-    DisposeStablePointer(job.executeAfter.operation);
-  }
+  delayed_.forEach([](KNativePtr operation) { DisposeStablePointer(operation); });
+  for (auto operation : cancelled_) DisposeStablePointer(operation);
 
   if (name_ != nullptr) DisposeStablePointer(name_);
 
   pthread_mutex_destroy(&lock_);
-  pthread_cond_destroy(&cond_);
 }
 
 namespace {
@@ -793,6 +2195,7 @@ void* workerRoutine(void* argument) {
   do {
     if (worker->processQueueElement(true) == JOB_TERMINATE) break;
   } while (true);
+  StopGcThreads();
 
   // Runtime deinit callback could be called when TLS is already zeroed out, so clear memory
   // here explicitly. to make sure leak detector properly works.
@@ -801,65 +2204,308 @@ void* workerRoutine(void* argument) {
   return nullptr;
 }
 
+void* poolThreadRoutine(void* argument) {
+  WorkerPool::Thread* thread = reinterpret_cast<WorkerPool::Thread*>(argument);
+
+  WorkerResume(thread->worker);
+  Kotlin_initRuntimeIfNeeded();
+
+  ::g_poolThread = thread;
+  // Note that the pool may be destroyed once this returns.
+  thread->pool->run(thread);
+  ::g_poolThread = nullptr;
+  StopGcThreads();
+
+  Kotlin_zeroOutTLSGlobals();
+
+  return nullptr;
+}
+
 }  // namespace
 
+WorkerPool::~WorkerPool() {
+  RuntimeAssert(injected_.size() == 0, "Pool must be drained");
+  for (auto* thread : threads_) {
+    konanDestructInstance(thread);
+  }
+  pthread_mutex_destroy(&lock_);
+  pthread_cond_destroy(&cond_);
+}
+
+void WorkerPool::start() {
+  for (auto* thread : threads_) {
+    Worker* worker = theState()->addWorkerUnlocked(errorReporting_, nullptr, WorkerKind::kPool);
+    RuntimeCheck(worker != nullptr, "Cannot create pool thread");
+    worker->setPool(this);
+    thread->worker = worker;
+    worker->startThread(poolThreadRoutine, thread);
+  }
+}
+
+void WorkerPool::run(Thread* thread) {
+  Worker* worker = thread->worker;
+  while (true) {
+    KInt wakeUps = atomicGet(&wakeUps_);
+    Job* job = takeJob(thread);
+    if (job != nullptr) {
+      if (atomicGet(&cancelling_)) {
+        cancelJob(*job);
+      } else if (job->kind == JOB_BATCH) {
+        worker->processBatchJob(*job);
+      } else {
+        GC_CollectorCallback(worker);
+        worker->processRegularJob(*job);
+      }
+      konanDestructInstance(job);
+      // Idle threads parked without timeout while this job was running, so let them see the pool is done.
+      if (atomicAdd(&running_, -1) == 0 && atomicGet(&terminating_))
+        wakeUpAll();
+      continue;
+    }
+    // Jobs sent to the thread directly, such as executeAfter() on Worker.current.
+    KLong timeoutMicroseconds = worker->checkQueue();
+    if (timeoutMicroseconds == 0) {
+      worker->processQueueElement(false);
+      continue;
+    }
+    // Running jobs may submit new ones, so the pool is only done once nothing runs.
+    if (atomicGet(&terminating_) && atomicGet(&running_) == 0 && atomicGet(&pending_) == 0 &&
+        (atomicGet(&cancelling_) || timeoutMicroseconds < 0)) {
+      break;
+    }
+    park(wakeUps, timeoutMicroseconds);
+  }
+
+  theState()->removeWorkerUnlocked(worker->id());
+  if (atomicAdd(&alive_, -1) == 0) {
+    Future* future = terminationFuture_;
+    // Nothing runs in the pool anymore, and submissions from outside are refused since termination was requested.
+    theState()->removePoolUnlocked(id_);
+    konanDestructInstance(this);
+    future->storeResultUnlocked(nullptr, true);
+  }
+}
+
+void WorkerPool::submit(Job* job) {
+  // Counted before the job is visible to thieves, so that it never goes negative.
+  atomicAdd(&pending_, 1);
+  if (::g_poolThread != nullptr && ::g_poolThread->pool == this) {
+    ::g_poolThread->deque.push(job);
+    notifyOne();
+  } else {
+    Locker locker(&lock_);
+    injected_.push_back(job);
+    atomicAdd(&injectedSize_, 1);
+    pthread_cond_signal(&cond_);
+  }
+}
+
+void WorkerPool::submitBatch(FutureGroup* group) {
+  KInt size = group->size();
+  atomicAdd(&pending_, size);
+  // Every element is a separate job, so that idle threads can steal them.
+  auto elementJob = [group](KInt index) {
+    group->retain();
+    Job* job = konanConstructInstance<Job>();
+    job->kind = JOB_BATCH;
+    job->batch.group = group;
+    job->batch.first = index;
+    job->batch.count = 1;
+    return job;
+  };
+  if (::g_poolThread != nullptr && ::g_poolThread->pool == this) {
+    for (KInt index = 0; index < size; index++) {
+      ::g_poolThread->deque.push(elementJob(index));
+    }
+    notifyOne();
+  } else {
+    Locker locker(&lock_);
+    for (KInt index = 0; index < size; index++) {
+      injected_.push_back(elementJob(index));
+    }
+    atomicAdd(&injectedSize_, size);
+    pthread_cond_broadcast(&cond_);
+  }
+}
+
+void WorkerPool::requestTermination(Future* future, bool processScheduledJobs) {
+  Locker locker(&lock_);
+  RuntimeAssert(terminationFuture_ == nullptr, "Termination must only be requested once");
+  terminationFuture_ = future;
+  atomicSet(&cancelling_, static_cast<KBoolean>(!processScheduledJobs));
+  atomicSet(&terminating_, static_cast<KBoolean>(true));
+  atomicAdd(&wakeUps_, 1);
+  pthread_cond_broadcast(&cond_);
+}
+
+bool WorkerPool::acceptsJobs() {
+  return !atomicGet(&terminating_) || (::g_poolThread != nullptr && ::g_poolThread->pool == this);
+}
+
+void WorkerPool::wakeUpAll() {
+  Locker locker(&lock_);
+  atomicAdd(&wakeUps_, 1);
+  pthread_cond_broadcast(&cond_);
+}
+
+Job* WorkerPool::takeJob(Thread* thread) {
+  Job* job = thread->deque.pop();
+  if (job == nullptr && atomicGet(&injectedSize_) > 0) {
+    Locker locker(&lock_);
+    if (injected_.size() != 0) {
+      job = injected_.front();
+      injected_.pop_front();
+      atomicAdd(&injectedSize_, -1);
+    }
+  }
+  KInt size = threads_.size();
+  for (KInt attempt = 1; job == nullptr && attempt < size; attempt++) {
+    thread->nextVictim = (thread->nextVictim + 1) % size;
+    if (thread->nextVictim == thread->index) continue;
+    job = threads_[thread->nextVictim]->deque.steal();
+  }
+  if (job == nullptr) return nullptr;
+  // Counted as running before it stops being pending, see the termination check in run().
+  atomicAdd(&running_, 1);
+  if (atomicAdd(&pending_, -1) > 0) {
+    // There is more work, let someone else help with it.
+    notifyOne();
+  }
+  return job;
+}
+
+void WorkerPool::park(KInt wakeUps, KLong timeoutMicroseconds) {
+  Locker locker(&lock_);
+  // Pairs with the check in notifyOne(): either the submitter sees this thread sleeping,
+  // or this thread sees the pending job.
+  atomicAdd(&sleeping_, 1);
+  if (atomicGet(&pending_) == 0 && atomicGet(&wakeUps_) == wakeUps) {
+    if (timeoutMicroseconds < 0) {
+      pthread_cond_wait(&cond_, &lock_);
+    } else {
+      // Protect from potential overflow, cutting at 10_000_000 seconds, aka 115 days.
+      if (timeoutMicroseconds > 10LL * 1000 * 1000 * 1000 * 1000)
+        timeoutMicroseconds = 10LL * 1000 * 1000 * 1000 * 1000;
+      WaitOnCondVar(&cond_, &lock_, timeoutMicroseconds * 1000LL);
+    }
+  }
+  atomicAdd(&sleeping_, -1);
+}
+
+void WorkerPool::notifyOne() {
+  if (atomicGet(&sleeping_) == 0) return;
+  Locker locker(&lock_);
+  pthread_cond_signal(&cond_);
+}
+
 void Worker::startEventLoop() {
-  pthread_create(&thread_, nullptr, workerRoutine, this);
+  startThread(workerRoutine, this);
+}
+
+void Worker::startThread(void* (*routine)(void*), void* argument) {
+  pthread_create(&thread_, nullptr, routine, argument);
 }
 
 void Worker::putJob(Job job, bool toFront) {
-  Locker locker(&lock_);
   if (toFront)
-    queue_.push_front(job);
+    urgentQueue_.push(job);
   else
-    queue_.push_back(job);
-  pthread_cond_signal(&cond_);
+    queue_.push(job);
+  event_.notify();
+  if (pool_ != nullptr) pool_->wakeUpAll();
 }
 
-void Worker::putDelayedJob(Job job) {
-  Locker locker(&lock_);
-  delayed_.insert(job);
-  pthread_cond_signal(&cond_);
+KLong Worker::putDelayedJob(KNativePtr operation, KLong afterMicroseconds) {
+  KLong handle;
+  {
+    Locker locker(&lock_);
+    handle = delayed_.add(operation, konan::getTimeMicros(), afterMicroseconds);
+  }
+  event_.notify();
+  if (pool_ != nullptr) pool_->wakeUpAll();
+  return handle;
+}
+
+bool Worker::cancelDelayedJob(KLong handle) {
+  KNativePtr operation = nullptr;
+  {
+    Locker locker(&lock_);
+    operation = delayed_.cancel(handle);
+    if (operation == nullptr) return false;
+    if (::g_worker != this) cancelled_.push_back(operation);
+  }
+  if (::g_worker == this) {
+    DisposeStablePointer(operation);
+  } else {
+    // Wake up the worker, it may wait for this job, or to terminate after all delayed jobs.
+    event_.notify();
+    if (pool_ != nullptr) pool_->wakeUpAll();
+  }
+  return true;
 }
 
 bool Worker::waitDelayed(bool blocking) {
-  Locker locker(&lock_);
-  if (delayed_.size() == 0) return false;
-  if (blocking) waitForQueueLocked(-1, nullptr);
+  {
+    Locker locker(&lock_);
+    if (delayed_.size() == 0) return false;
+  }
+  // Returns once a delayed job is due or cancelled, so that the caller checks again.
+  if (blocking) waitForQueue(kMaxWaitMicroseconds, nullptr);
   return true;
 }
 
 Job Worker::getJob(bool blocking) {
-  Locker locker(&lock_);
   RuntimeAssert(!terminated_, "Must not be terminated");
-  if (queue_.size() == 0 && !blocking) return Job { .kind = JOB_NONE };
-  waitForQueueLocked(-1, nullptr);
-  auto result = queue_.front();
-  queue_.pop_front();
+  Job result;
+  if (popJob(&result)) return result;
+  if (!blocking) return Job { .kind = JOB_NONE };
+  waitForQueue(-1, nullptr);
+  RuntimeCheck(popJob(&result), "Queue must not be empty");
   return result;
 }
 
-KLong Worker::checkDelayedLocked() {
+bool Worker::popJob(Job* job) {
+  return urgentQueue_.pop(job) || queue_.pop(job);
+}
+
+bool Worker::hasJobs() {
+  return !urgentQueue_.empty() || !queue_.empty();
+}
+
+KLong Worker::checkDelayed() {
+  Locker locker(&lock_);
+  for (auto operation : cancelled_) DisposeStablePointer(operation);
+  cancelled_.clear();
   if (delayed_.size() == 0) {
     return -1;
   }
-  auto it = delayed_.begin();
-  auto job = *it;
-  RuntimeAssert(job.kind == JOB_EXECUTE_AFTER, "Must be delayed job");
-  auto now = konan::getTimeMicros();
-  if (job.executeAfter.whenExecute <= now) {
-    delayed_.erase(it);
-    queue_.push_back(job);
-    return 0;
-  } else {
-    return job.executeAfter.whenExecute - now;
-  }
+  bool moved = false;
+  KLong closestToRunMicroseconds = delayed_.advance(konan::getTimeMicros(), [this, &moved](KNativePtr operation) {
+    Job job;
+    job.kind = JOB_EXECUTE_AFTER;
+    job.executeAfter.operation = operation;
+    queue_.push(job);
+    moved = true;
+  });
+  return moved ? 0 : closestToRunMicroseconds;
+}
+
+KLong Worker::checkQueue() {
+  if (hasJobs()) return 0;
+  return checkDelayed();
 }
 
-bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining) {
-  while (queue_.size() == 0) {
-    KLong closestToRunMicroseconds = checkDelayedLocked();
+bool Worker::waitForQueue(KLong timeoutMicroseconds, KLong* remaining) {
+  while (true) {
+    // Prepare to wait before checking, so that a job added after the checks wakes us up.
+    auto key = event_.prepareWait();
+    if (hasJobs()) {
+      event_.cancelWait();
+      return true;
+    }
+    KLong closestToRunMicroseconds = checkDelayed();
     if (closestToRunMicroseconds == 0) {
+        event_.cancelWait();
         continue;
     }
     if (timeoutMicroseconds >= 0) {
@@ -869,50 +2515,44 @@ bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining) {
     }
     if (closestToRunMicroseconds == 0) {
       // Just no wait at all here.
+      event_.cancelWait();
     } else if (closestToRunMicroseconds > 0) {
-      // Protect from potential overflow, cutting at 10_000_000 seconds, aka 115 days.
-      if (closestToRunMicroseconds > 10LL * 1000 * 1000 * 1000 * 1000)
-        closestToRunMicroseconds = 10LL * 1000 * 1000 * 1000 * 1000;
-      uint64_t nsDelta = closestToRunMicroseconds * 1000LL;
-      uint64_t microsecondsPassed = 0;
-      WaitOnCondVar(&cond_, &lock_, nsDelta, remaining ? &microsecondsPassed : nullptr);
+      // Protect from potential overflow.
+      if (closestToRunMicroseconds > kMaxWaitMicroseconds)
+        closestToRunMicroseconds = kMaxWaitMicroseconds;
+      auto startMicroseconds = konan::getTimeMicros();
+      event_.commitWait(key, closestToRunMicroseconds);
       if (remaining) {
-        *remaining = timeoutMicroseconds - microsecondsPassed;
+        *remaining = timeoutMicroseconds - (konan::getTimeMicros() - startMicroseconds);
       }
     } else {
-      pthread_cond_wait(&cond_, &lock_);
+      event_.commitWait(key, -1);
       if (remaining) *remaining = 0;
     }
-    if (timeoutMicroseconds >= 0) return queue_.size() != 0;
+    if (timeoutMicroseconds >= 0) return hasJobs();
   }
-  return true;
 }
 
 bool Worker::park(KLong timeoutMicroseconds, bool process) {
-  {
-    Locker locker(&lock_);
-    if (terminated_) {
-      return false;
-    }
-    auto arrived = false;
-    KLong remaining = timeoutMicroseconds;
-    do {
-      arrived = waitForQueueLocked(remaining, &remaining);
-    } while (remaining > 0 && !arrived);
-    if (!process) {
-      return arrived;
-    }
-    if (!arrived) {
-      return false;
-    }
+  if (terminated_) {
+    return false;
+  }
+  auto arrived = false;
+  KLong remaining = timeoutMicroseconds;
+  do {
+    arrived = waitForQueue(remaining, &remaining);
+  } while (remaining > 0 && !arrived);
+  if (!process) {
+    return arrived;
+  }
+  if (!arrived) {
+    return false;
   }
   return processQueueElement(false) >= JOB_REGULAR;
 }
 
 JobKind Worker::processQueueElement(bool blocking) {
   GC_CollectorCallback(this);
-  ObjHolder argumentHolder;
-  ObjHolder resultHolder;
   if (terminated_) return JOB_TERMINATE;
   Job job = getJob(blocking);
   switch (job.kind) {
@@ -945,22 +2585,12 @@ JobKind Worker::processQueueElement(bool blocking) {
       break;
     }
     case JOB_REGULAR: {
-      KRef argument = AdoptStablePointer(job.regularJob.argument, argumentHolder.slot());
-      KNativePtr result = nullptr;
-      bool ok = true;
-      try {
-        job.regularJob.function(argument, resultHolder.slot());
-        argumentHolder.clear();
-        // Transfer the result.
-        result = transfer(&resultHolder, job.regularJob.transferMode);
-       } catch (ExceptionObjHolder& e) {
-         ok = false;
-         if (errorReporting())
-           ReportUnhandledException(e.obj());
-       }
-       // Notify the future.
-       job.regularJob.future->storeResultUnlocked(result, ok);
-       break;
+      processRegularJob(job);
+      break;
+    }
+    case JOB_BATCH: {
+      processBatchJob(job);
+      break;
     }
     default: {
       RuntimeCheck(false, "Must be exhaustive");
@@ -969,6 +2599,45 @@ JobKind Worker::processQueueElement(bool blocking) {
   return job.kind;
 }
 
+void Worker::processRegularJob(const Job& job) {
+  bool ok = true;
+  KNativePtr result = runJobFunction(
+      job.regularJob.function, job.regularJob.argument, job.regularJob.transferMode, &ok);
+  // Notify the future.
+  job.regularJob.future->storeResultUnlocked(result, ok);
+}
+
+void Worker::processBatchJob(const Job& job) {
+  FutureGroup* group = job.batch.group;
+  for (KInt index = job.batch.first; index < job.batch.first + job.batch.count; index++) {
+    GC_CollectorCallback(this);
+    bool ok = true;
+    KNativePtr result = runJobFunction(WorkerLaunchpad, group->takeArgument(index), group->transferMode(), &ok);
+    group->storeResult(index, result, ok ? COMPUTED : THROWN);
+  }
+  group->release();
+}
+
+KNativePtr Worker::runJobFunction(
+    KRef (*function)(KRef, ObjHeader**), KNativePtr argument, KInt transferMode, bool* ok) {
+  ObjHolder argumentHolder;
+  ObjHolder resultHolder;
+  KRef argumentObj = AdoptStablePointer(argument, argumentHolder.slot());
+  KNativePtr result = nullptr;
+  *ok = true;
+  try {
+    function(argumentObj, resultHolder.slot());
+    argumentHolder.clear();
+    // Transfer the result.
+    result = transfer(&resultHolder, transferMode);
+  } catch (ExceptionObjHolder& e) {
+    *ok = false;
+    if (errorReporting())
+      ReportUnhandledException(e.obj());
+  }
+  return result;
+}
+
 #endif  // WITH_WORKERS
 
 extern "C" {
@@ -989,8 +2658,12 @@ KInt Kotlin_Worker_executeInternal(KInt id, KInt transferMode, KRef producer, KN
   return execute(id, transferMode, producer, job);
 }
 
-void Kotlin_Worker_executeAfterInternal(KInt id, KRef job, KLong afterMicroseconds) {
-  executeAfter(id, job, afterMicroseconds);
+KLong Kotlin_Worker_executeAfterInternal(KInt id, KRef job, KLong afterMicroseconds) {
+  return executeAfter(id, job, afterMicroseconds);
+}
+
+KBoolean Kotlin_Worker_cancelDelayedJobInternal(KInt id, KLong handle) {
+  return cancelDelayedJob(id, handle);
 }
 
 KBoolean Kotlin_Worker_processQueueInternal(KInt id) {
@@ -1029,6 +2702,62 @@ KNativePtr Kotlin_Worker_detachObjectGraphInternal(KInt transferMode, KRef produ
   return detachObjectGraphInternal(transferMode, producer);
 }
 
+KInt Kotlin_WorkerPool_startInternal(KInt size, KBoolean errorReporting) {
+  return startWorkerPool(size, errorReporting);
+}
+
+KInt Kotlin_WorkerPool_executeInternal(KInt id, KInt transferMode, KRef producer) {
+  return executeInWorkerPool(id, transferMode, producer);
+}
+
+KInt Kotlin_WorkerPool_requestTerminationInternal(KInt id, KBoolean processScheduledJobs) {
+  return requestWorkerPoolTermination(id, processScheduledJobs);
+}
+
+KInt Kotlin_Worker_executeBatchInternal(KInt id, KInt transferMode, KInt count, KRef producer) {
+  return executeBatch(id, transferMode, count, producer);
+}
+
+KInt Kotlin_WorkerPool_executeBatchInternal(KInt id, KInt transferMode, KInt count, KRef producer) {
+  return executeBatchInWorkerPool(id, transferMode, count, producer);
+}
+
+KInt Kotlin_FutureGroup_size(KInt id) {
+  return sizeOfFutureGroup(id);
+}
+
+KInt Kotlin_FutureGroup_stateOf(KInt id, KInt index) {
+  return stateOfFutureGroupElement(id, index);
+}
+
+KBoolean Kotlin_FutureGroup_awaitAll(KInt id, KInt millis) {
+  return awaitAllOfFutureGroup(id, millis);
+}
+
+KInt Kotlin_FutureGroup_awaitAny(KInt id, KInt millis) {
+  return awaitAnyOfFutureGroup(id, millis);
+}
+
+OBJ_GETTER(Kotlin_FutureGroup_consume, KInt id, KInt index) {
+  RETURN_RESULT_OF(consumeFutureGroupElement, id, index);
+}
+
+KInt Kotlin_WorkerChannel_createInternal(KInt capacity) {
+  return createChannel(capacity);
+}
+
+KBoolean Kotlin_WorkerChannel_sendInternal(KInt id, KInt transferMode, KRef producer, KBoolean blocking) {
+  return sendToChannel(id, transferMode, producer, blocking);
+}
+
+OBJ_GETTER(Kotlin_WorkerChannel_receiveInternal, KInt id, KBoolean blocking) {
+  RETURN_RESULT_OF(receiveFromChannel, id, blocking);
+}
+
+void Kotlin_WorkerChannel_closeInternal(KInt id) {
+  closeChannel(id);
+}
+
 void Kotlin_Worker_freezeInternal(KRef object) {
   if (object != nullptr)
     FreezeSubgraph(object);
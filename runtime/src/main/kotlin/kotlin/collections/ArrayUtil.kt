@@ -152,6 +152,17 @@ internal external fun arrayCopy(array: DoubleArray, fromIndex: Int, destination:
 @SymbolName("Kotlin_BooleanArray_copyImpl")
 internal external fun arrayCopy(array: BooleanArray, fromIndex: Int, destination: BooleanArray, toIndex: Int, count: Int)
 
+/**
+ * Grows the array to [newSize] zero elements without moving it, if the memory after it is available, which is
+ * only the case for large arrays. Returns `false` if the array was left intact, so the caller has to copy it.
+ * Only use it for arrays not shared with any other code, as their size changes.
+ */
+@SymbolName("Kotlin_ByteArray_growInPlace")
+internal external fun ByteArray.growInPlace(newSize: Int): Boolean
+
+@SymbolName("Kotlin_CharArray_growInPlace")
+internal external fun CharArray.growInPlace(newSize: Int): Boolean
+
 
 internal fun <E> Collection<E>.collectionToString(): String {
     val sb = StringBuilder(2 + size * 3)
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+import kotlin.native.internal.Frozen
+
+/**
+ * Handle of a job planned with [Worker.executeAfter], allowing to cancel the job before it's executed.
+ * Handle is frozen, so it can be passed to other workers, and the job can be cancelled from any of them.
+ */
+@Frozen
+public class DelayedJob internal constructor(
+        /**
+         * Worker the job is planned on.
+         */
+        public val worker: Worker,
+        private val handle: Long) {
+    /**
+     * Cancels the job, unless it is already executed or about to be. Note that jobs planned with
+     * zero delay are queued right away, and so cannot be cancelled.
+     *
+     * @return `true` if the job is cancelled and will never be executed, `false` otherwise.
+     */
+    public fun cancel(): Boolean = cancelDelayedJobInternal(worker.id, handle)
+
+    override public fun toString(): String = "delayed job on $worker"
+}
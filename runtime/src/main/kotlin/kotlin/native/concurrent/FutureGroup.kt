@@ -0,0 +1,67 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+/**
+ * Class representing results of a batch of jobs, submitted with [Worker.executeBatch] or [WorkerPool.executeBatch].
+ * Every element behaves like a separate [Future], but the whole group is completed and awaited at once,
+ * which is much cheaper than a collection of futures for many small jobs.
+ * The group becomes invalid once all its elements are consumed: its elements are in [FutureState.INVALID] state,
+ * [awaitAll] returns `true` and [awaitAny] returns -1 right away.
+ */
+@Suppress("NON_PUBLIC_PRIMARY_CONSTRUCTOR_OF_INLINE_CLASS")
+public inline class FutureGroup<T> @PublishedApi internal constructor(val id: Int) {
+    /**
+     * Number of elements in the group.
+     *
+     * @throws IllegalStateException if all elements are consumed already.
+     */
+    public val size: Int
+        get() = sizeOfFutureGroup(id)
+
+    /**
+     * A [FutureState] of the element with the given [index].
+     */
+    public fun state(index: Int): FutureState = FutureState.values()[stateOfFutureGroupElement(id, index)]
+
+    /**
+     * Blocks execution until all elements of the group are ready.
+     *
+     * @param timeoutMillis the amount of time in milliseconds to wait, waits forever if -1.
+     * @return `true` if all elements are ready and `false` on timeout.
+     */
+    public fun awaitAll(timeoutMillis: Int = -1): Boolean = awaitAllOfFutureGroup(id, timeoutMillis)
+
+    /**
+     * Blocks execution until an element of the group is ready. Elements are returned in the order they become ready,
+     * every element once, regardless of whether it has been consumed.
+     *
+     * @param timeoutMillis the amount of time in milliseconds to wait, waits forever if -1.
+     * @return index of the ready element, or -1 on timeout or if all elements were already returned.
+     */
+    public fun awaitAny(timeoutMillis: Int = -1): Int = awaitAnyOfFutureGroup(id, timeoutMillis)
+
+    /**
+     * Blocks execution until the element with the given [index] is ready, and returns its result.
+     * Second attempt to get the same element will result in an error.
+     *
+     * @throws IllegalStateException if the element is cancelled, its job has thrown an exception
+     * or it is already consumed.
+     * @throws ArrayIndexOutOfBoundsException if [index] is out of the group bounds.
+     */
+    public fun result(index: Int): T =
+            @Suppress("UNCHECKED_CAST")
+            (consumeFutureGroupElement(id, index) as T)
+
+    /**
+     * Blocks execution until the element with the given [index] is ready, and consumes its result with [code].
+     *
+     * @see result
+     */
+    public inline fun <R> consume(index: Int, code: (T) -> R): R = code(result(index))
+
+    override public fun toString(): String = "future group $id"
+}
@@ -46,7 +46,10 @@ external internal fun executeInternal(
         id: Int, mode: Int, producer: () -> Any?, job: CPointer<CFunction<*>>): Int
 
 @SymbolName("Kotlin_Worker_executeAfterInternal")
-external internal fun executeAfterInternal(id: Int, operation: () -> Unit, afterMicroseconds: Long): Unit
+external internal fun executeAfterInternal(id: Int, operation: () -> Unit, afterMicroseconds: Long): Long
+
+@SymbolName("Kotlin_Worker_cancelDelayedJobInternal")
+external internal fun cancelDelayedJobInternal(id: Int, handle: Long): Boolean
 
 @SymbolName("Kotlin_Worker_processQueueInternal")
 external internal fun processQueueInternal(id: Int): Boolean
@@ -57,6 +60,55 @@ external internal fun parkInternal(id: Int, timeoutMicroseconds: Long, process:
 @SymbolName("Kotlin_Worker_getNameInternal")
 external internal fun getWorkerNameInternal(id: Int): String?
 
+@SymbolName("Kotlin_WorkerPool_startInternal")
+external internal fun startWorkerPoolInternal(size: Int, errorReporting: Boolean): Int
+
+@SymbolName("Kotlin_WorkerPool_executeInternal")
+external internal fun executeInWorkerPoolInternal(id: Int, mode: Int, producer: () -> Any?): Int
+
+@SymbolName("Kotlin_WorkerPool_requestTerminationInternal")
+external internal fun requestWorkerPoolTerminationInternal(id: Int, processScheduledJobs: Boolean): Int
+
+@SymbolName("Kotlin_Worker_executeBatchInternal")
+external internal fun executeBatchInternal(id: Int, mode: Int, count: Int, producer: (Int) -> Any?): Int
+
+@SymbolName("Kotlin_WorkerPool_executeBatchInternal")
+external internal fun executeBatchInWorkerPoolInternal(id: Int, mode: Int, count: Int, producer: (Int) -> Any?): Int
+
+@SymbolName("Kotlin_FutureGroup_size")
+external internal fun sizeOfFutureGroup(id: Int): Int
+
+@SymbolName("Kotlin_FutureGroup_stateOf")
+external internal fun stateOfFutureGroupElement(id: Int, index: Int): Int
+
+@SymbolName("Kotlin_FutureGroup_awaitAll")
+external internal fun awaitAllOfFutureGroup(id: Int, timeoutMillis: Int): Boolean
+
+@SymbolName("Kotlin_FutureGroup_awaitAny")
+external internal fun awaitAnyOfFutureGroup(id: Int, timeoutMillis: Int): Int
+
+@SymbolName("Kotlin_FutureGroup_consume")
+external internal fun consumeFutureGroupElement(id: Int, index: Int): Any?
+
+@SymbolName("Kotlin_WorkerChannel_createInternal")
+external internal fun createWorkerChannelInternal(capacity: Int): Int
+
+@SymbolName("Kotlin_WorkerChannel_sendInternal")
+external internal fun sendToWorkerChannelInternal(id: Int, mode: Int, producer: () -> Any?, blocking: Boolean): Boolean
+
+@SymbolName("Kotlin_WorkerChannel_receiveInternal")
+external internal fun receiveFromWorkerChannelInternal(id: Int, blocking: Boolean): Any?
+
+@SymbolName("Kotlin_WorkerChannel_closeInternal")
+external internal fun closeWorkerChannelInternal(id: Int): Unit
+
+// Wraps the job of a batch element, so that it's transferred together with its argument.
+internal fun <T1, T2> batchProducer(producer: (Int) -> T1, job: (T1) -> T2): (Int) -> Any? = { index ->
+    val argument = producer(index)
+    val task: () -> T2 = { job(argument) }
+    task
+}
+
 @ExportForCppRuntime
 internal fun ThrowWorkerUnsupported(): Unit =
         throw UnsupportedOperationException("Workers are not supported")
@@ -68,6 +120,9 @@ internal fun ThrowWorkerInvalidState(): Unit =
 @ExportForCppRuntime
 internal fun WorkerLaunchpad(function: () -> Any?) = function()
 
+@ExportForCppRuntime
+internal fun WorkerBatchLaunchpad(function: (Int) -> Any?, index: Int) = function(index)
+
 @PublishedApi
 @SymbolName("Kotlin_Worker_detachObjectGraphInternal")
 external internal fun detachObjectGraphInternal(mode: Int, producer: () -> Any?): NativePtr
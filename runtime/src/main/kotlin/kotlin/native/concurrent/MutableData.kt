@@ -40,10 +40,13 @@ public class MutableData constructor(capacity: Int = 16) {
         assert(newSize >= size)
         if (newSize > buffer.size) {
             val actualSize = maxOf(buffer.size * 3 / 2 + 1, newSize)
-            val newBuffer = ByteArray(actualSize)
-            buffer.copyInto(newBuffer, startIndex = 0, endIndex = size)
-            newBuffer.share()
-            buffer = newBuffer
+            // Big buffers are usually extended without copying.
+            if (!buffer.growInPlace(actualSize)) {
+                val newBuffer = ByteArray(actualSize)
+                buffer.copyInto(newBuffer, startIndex = 0, endIndex = size)
+                newBuffer.share()
+                buffer = newBuffer
+            }
         }
         val position = size
         size_ = newSize
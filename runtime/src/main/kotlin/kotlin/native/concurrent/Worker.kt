@@ -96,19 +96,36 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
              */
             throw RuntimeException("Shall not be called directly")
 
+    /**
+     * Plan a batch of [count] jobs for further execution in the worker, with a single queue operation.
+     * For every index [producer] is executed, and its result, together with the [job] function, is transferred
+     * to the worker as an isolated object subgraph, if in checked mode. So unlike [execute], [job] may capture state,
+     * as long as it is a part of the transferred subgraph. The worker executes jobs of the batch in order.
+     *
+     * @return the group of futures with the computation results of [job], one per index.
+     * @throws [IllegalArgumentException] if [count] is not positive.
+     */
+    public fun <T1, T2> executeBatch(mode: TransferMode, count: Int, producer: (Int) -> T1, job: (T1) -> T2): FutureGroup<T2> {
+        if (count <= 0) throw IllegalArgumentException("Batch must not be empty")
+        return FutureGroup<T2>(executeBatchInternal(id, mode.value, count, batchProducer(producer, job)))
+    }
+
     /**
      * Plan job for further execution in the worker. [operation] parameter must be either frozen, or execution to be
      * planned on the current worker. Otherwise [IllegalStateException] will be thrown.
      *
+     * Delayed jobs are executed no earlier than planned, and with about 0.1 ms precision.
+     *
      * @param afterMicroseconds defines after how many microseconds delay execution shall happen, 0 means immediately,
+     * @return handle of the job, allowing to cancel it.
      * @throws [IllegalArgumentException] on negative values of [afterMicroseconds].
      * @throws [IllegalStateException] if [operation] parameter is not frozen and worker is not current.
      */
-    public fun executeAfter(afterMicroseconds: Long = 0, operation: () -> Unit): Unit {
+    public fun executeAfter(afterMicroseconds: Long = 0, operation: () -> Unit): DelayedJob {
         val current = currentInternal()
         if (current != id && !operation.isFrozen) throw IllegalStateException("Job for another worker must be frozen")
         if (afterMicroseconds < 0) throw IllegalArgumentException("Timeout parameter must be non-negative")
-        executeAfterInternal(id, operation, afterMicroseconds)
+        return DelayedJob(this, executeAfterInternal(id, operation, afterMicroseconds))
     }
 
     /**
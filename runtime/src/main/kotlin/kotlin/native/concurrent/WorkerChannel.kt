@@ -0,0 +1,81 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+/**
+ * Bounded channel passing object subgraphs between workers, for example between the stages of a pipeline.
+ * Any number of workers may send and receive messages.
+ *
+ * Messages are transferred the same way as arguments of [Worker.execute], see [TransferMode] for more details.
+ * In [TransferMode.SAFE] mode, subgraphs nobody else has seen yet, such as just built by the producer function,
+ * are recognized with a check much cheaper than the full one.
+ *
+ * Blocked [send] and [receive] park the worker, which meanwhile keeps processing its own jobs,
+ * just like [Worker.park] with `process = true` does.
+ * Channel is destroyed once it is closed and all its messages are received.
+ */
+@Suppress("NON_PUBLIC_PRIMARY_CONSTRUCTOR_OF_INLINE_CLASS")
+public inline class WorkerChannel<T : Any> @PublishedApi internal constructor(val id: Int) {
+    companion object {
+        /**
+         * Create new channel.
+         *
+         * @param capacity how many messages the channel holds before [send] blocks.
+         * @throws [IllegalArgumentException] if [capacity] is not positive.
+         */
+        public fun <T : Any> create(capacity: Int): WorkerChannel<T> {
+            if (capacity <= 0) throw IllegalArgumentException("Channel capacity must be positive")
+            return WorkerChannel<T>(createWorkerChannelInternal(capacity))
+        }
+    }
+
+    /**
+     * Send the result of [producer] to the channel, waiting until there is room for it.
+     * [producer] is only executed once there is room.
+     *
+     * @throws [IllegalStateException] if the channel is closed, the object graph is not isolated,
+     * or the worker is terminated while waiting.
+     */
+    public fun send(mode: TransferMode, producer: () -> T): Unit {
+        sendToWorkerChannelInternal(id, mode.value, producer, true)
+    }
+
+    /**
+     * Send the result of [producer] to the channel, if there is room for it. Otherwise [producer] is not executed.
+     *
+     * @return `true` if the message is sent, and `false` if the channel is full.
+     * @throws [IllegalStateException] if the channel is closed or the object graph is not isolated.
+     */
+    public fun trySend(mode: TransferMode, producer: () -> T): Boolean =
+            sendToWorkerChannelInternal(id, mode.value, producer, false)
+
+    /**
+     * Receive the next message, waiting until there is one.
+     *
+     * @throws [IllegalStateException] if the channel is closed and has no messages left,
+     * or the worker is terminated while waiting.
+     */
+    public fun receive(): T =
+            @Suppress("UNCHECKED_CAST")
+            (receiveFromWorkerChannelInternal(id, true) as T)
+
+    /**
+     * Receive the next message, if there is one.
+     *
+     * @return the message, or `null` if there are no messages in the channel.
+     */
+    public fun tryReceive(): T? =
+            @Suppress("UNCHECKED_CAST")
+            (receiveFromWorkerChannelInternal(id, false) as T?)
+
+    /**
+     * Close the channel. No messages can be sent once it is closed, but those already sent still can be received.
+     * Closing the channel again has no effect.
+     */
+    public fun close(): Unit = closeWorkerChannelInternal(id)
+
+    override public fun toString(): String = "worker channel $id"
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+/**
+ * Class representing a pool of worker threads executing jobs from a shared stream.
+ *
+ * Unlike [Worker.execute], which queues the job to the given worker, a job submitted to the pool is executed
+ * by whichever of its threads is free first: every thread keeps own queue of jobs, and idle threads steal jobs
+ * from the queues of busy ones. Jobs submitted from a job already running in the pool are queued to the current
+ * thread, so that fork-join style computations keep their data local.
+ * Objects are passed to and from the pool with the same transfer operation as to and from [Worker],
+ * see [TransferMode] for more details.
+ */
+@Suppress("NON_PUBLIC_PRIMARY_CONSTRUCTOR_OF_INLINE_CLASS")
+public inline class WorkerPool @PublishedApi internal constructor(val id: Int) {
+    companion object {
+        /**
+         * Start new pool of worker threads.
+         *
+         * @param size number of threads in the pool.
+         * @param errorReporting controls if an uncaught exceptions in the jobs will be printed out.
+         * @return pool object, usable across multiple concurrent contexts.
+         * @throws [IllegalArgumentException] if [size] is not positive.
+         */
+        public fun start(size: Int, errorReporting: Boolean = true): WorkerPool {
+            if (size <= 0) throw IllegalArgumentException("Pool size must be positive")
+            return WorkerPool(startWorkerPoolInternal(size, errorReporting))
+        }
+    }
+
+    /**
+     * Requests termination of the pool. Once requested, no new jobs can be submitted to the pool from outside,
+     * but jobs running in the pool still may submit new ones.
+     *
+     * @param processScheduledJobs controls if we shall wait until all scheduled jobs processed, or cancel them.
+     * @return the future, which becomes ready once all threads of the pool exited.
+     * @throws [IllegalStateException] if termination of the pool was already requested.
+     */
+    public fun requestTermination(processScheduledJobs: Boolean = true): Future<Unit> =
+            Future<Unit>(requestWorkerPoolTerminationInternal(id, processScheduledJobs))
+
+    /**
+     * Plan job for further execution in the pool. Just like [Worker.execute] it's a two-phase operation:
+     * first [producer] function is executed, and its result, together with the [job] function, is transferred
+     * to the pool as an isolated object subgraph, if in checked mode. So unlike [Worker.execute], [job] may capture
+     * state, as long as it is a part of the transferred subgraph. Result of the [job] execution is transferred back
+     * to whoever consumes the future.
+     *
+     * @return the future with the computation result of [job].
+     * @throws [IllegalStateException] if the pool is terminated or the object graph is not isolated.
+     */
+    public fun <T1, T2> execute(mode: TransferMode, producer: () -> T1, job: (T1) -> T2): Future<T2> =
+            Future<T2>(executeInWorkerPoolInternal(id, mode.value) {
+                val argument = producer()
+                val task: () -> T2 = { job(argument) }
+                task
+            })
+
+    /**
+     * Plan a batch of [count] jobs for further execution in the pool, see [Worker.executeBatch].
+     * Jobs of the batch are executed concurrently by the threads of the pool.
+     *
+     * @return the group of futures with the computation results of [job], one per index.
+     * @throws [IllegalArgumentException] if [count] is not positive.
+     * @throws [IllegalStateException] if the pool is terminated or an object graph is not isolated.
+     */
+    public fun <T1, T2> executeBatch(mode: TransferMode, count: Int, producer: (Int) -> T1, job: (T1) -> T2): FutureGroup<T2> {
+        if (count <= 0) throw IllegalArgumentException("Batch must not be empty")
+        return FutureGroup<T2>(executeBatchInWorkerPoolInternal(id, mode.value, count, batchProducer(producer, job)))
+    }
+
+    /**
+     * String representation of the pool.
+     */
+    override public fun toString(): String = "WorkerPool $id"
+}
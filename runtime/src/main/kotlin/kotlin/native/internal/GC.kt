@@ -5,6 +5,8 @@
 
 package kotlin.native.internal
 
+import kotlin.native.concurrent.ThreadLocal
+
 /**
  *  ## Cycle garbage collector interface.
  *
@@ -35,6 +37,36 @@ object GC {
     @SymbolName("Kotlin_native_internal_GC_collectCyclic")
     external fun collectCyclic()
 
+    /**
+     * Writes a snapshot of objects reachable from the stack, global and thread local variables
+     * of the current worker and, if [stablePointerRoots] is enabled, from stable pointers to the file at [path].
+     * Use tools/heapdump/heapReport.py to get the dominator tree report from it.
+     *
+     * @throws IllegalArgumentException if the file cannot be written.
+     */
+    @SymbolName("Kotlin_native_internal_GC_dumpHeap")
+    external fun dumpHeap(path: String)
+
+    /**
+     * If stable pointers are tracked, so that [dumpHeap] reports the objects they refer to as roots.
+     * Only stable pointers created while it is enabled are reported. Applies to all workers,
+     * disabled by default, as tracking takes a global lock on every creation and disposal of a stable pointer.
+     */
+    var stablePointerRoots: Boolean
+        get() = getStablePointerRoots()
+        set(value) = setStablePointerRoots(value)
+
+    /**
+     * Collects garbage of the current worker, like [collect], and returns memory no longer used by it
+     * to the operating system: frees the memory kept by the worker for reuse, and asks the allocator
+     * to release its free pages. Useful when the worker becomes idle after a spike of allocations.
+     *
+     * @return by how many bytes the estimated heap size has shrunk since its peak after the previous trim,
+     * i.e. an upper bound of the memory returned.
+     */
+    @SymbolName("Kotlin_native_internal_GC_trimHeap")
+    external fun trimHeap(): Long
+
     /**
      * Suspend garbage collection. Release candidates are still collected, but
      * GC algorithm is not executed.
@@ -77,6 +109,16 @@ object GC {
         get() = getCollectCyclesThreshold()
         set(value) = setCollectCyclesThreshold(value)
 
+    /**
+     * Upper bound of the GC pause in microseconds, which cycle collection tries to keep.
+     * Cycle candidates are processed in slices until the budget is exhausted, and the rest is
+     * processed during the next collections, trading total GC time for shorter pauses.
+     * Zero means unlimited, forced collection with [collect] always ignores the budget.
+     */
+    var maxPauseMicros: Long
+        get() = getMaxPauseMicros()
+        set(value) = setMaxPauseMicros(value)
+
     /**
      * GC allocation threshold, controlling how many bytes allocated since last
      * collection will trigger new GC.
@@ -92,6 +134,95 @@ object GC {
         get() = getTuneThreshold()
         set(value) = setTuneThreshold(value)
 
+    /**
+     * Fraction of the program time, which auto-tuned GC aims to spend in collection, must be in (0, 1) range.
+     * Bigger values mean more frequent collections and smaller heap.
+     */
+    var targetOverhead: Double
+        get() = getTargetOverhead()
+        set(value) = setTargetOverhead(value)
+
+    /**
+     * Size of the heap allocated by the current worker in bytes, which auto-tuned GC tries not to exceed
+     * by collecting more often. Zero means no target.
+     */
+    var targetHeapBytes: Long
+        get() = getTargetHeapBytes()
+        set(value) = setTargetHeapBytes(value)
+
+    /**
+     * Size of the heap allocated by the current worker in bytes, crossing which forces collection,
+     * including cyclic garbage. If the heap is still above the limit, [softHeapLimitHandler] is called.
+     * The limit is checked on allocation; if an object crosses it, the handler is called on the next allocation
+     * of an array or [collect].
+     * Must not exceed [hardHeapLimit], if it's set. Zero means no limit.
+     */
+    var softHeapLimit: Long
+        get() = getSoftHeapLimit()
+        set(value) = setSoftHeapLimit(value)
+
+    /**
+     * Size of the heap allocated by the current worker in bytes, which it cannot exceed: if collection
+     * does not free enough memory, allocation of an array throws [OutOfMemoryError].
+     * Allocation of an object cannot throw, so if an object crosses the limit, the error is thrown
+     * by the next allocation of an array or [collect].
+     * Must not be less than [softHeapLimit]. Zero means no limit.
+     */
+    var hardHeapLimit: Long
+        get() = getHardHeapLimit()
+        set(value) = setHardHeapLimit(value)
+
+    /**
+     * Called by the current worker with the heap size in bytes, when the heap stays above [softHeapLimit]
+     * after collection, so that the application could shed load. Called again only after the heap grows
+     * by an eighth of the limit, or drops below the limit and crosses it again.
+     * Objects allocated by the handler itself do not trigger it.
+     */
+    var softHeapLimitHandler: ((Long) -> Unit)?
+        get() = HeapLimits.softHeapLimitHandler
+        set(value) {
+            HeapLimits.softHeapLimitHandler = value
+        }
+
+    /**
+     * If the current worker shall return memory to the operating system automatically, as with [trimHeap],
+     * when collection finds that its heap has shrunk to half of its peak size since the previous trim.
+     * Heap is trimmed no more often than once a second.
+     */
+    var autoTrim: Boolean
+        get() = getAutoTrim()
+        set(value) = setAutoTrim(value)
+
+    /**
+     * Estimated size of the heap allocated by the current worker in bytes.
+     */
+    val heapBytes: Long
+        get() = getHeapBytes()
+
+    /**
+     * Snapshot of GC counters of the current worker.
+     */
+    val statistics: GCStatistics
+        get() = GCStatistics(LongArray(GCStatistics.SIZE).also { getStatistics(it) })
+
+
+    /**
+     * If mark phase of the cycle collector shall run on a helper thread, concurrently with the program.
+     * Only the final phase, proportional to the amount of cyclic garbage found, is performed during GC pause.
+     * Not supported on targets without threads.
+     */
+    var concurrentMark: Boolean
+        get() = getConcurrentMark()
+        set(value) = setConcurrentMark(value)
+
+    /**
+     * Number of helper threads, which update reference counters of frozen and shared objects during GC,
+     * when there is enough such work. Thread-local objects are always processed by the worker itself.
+     * Zero means no helpers, not supported on targets without threads.
+     */
+    var helperThreads: Int
+        get() = getHelperThreads()
+        set(value) = setHelperThreads(value)
 
     /**
      * If cyclic collector for atomic references to be deployed.
@@ -112,6 +243,12 @@ object GC {
     @SymbolName("Kotlin_native_internal_GC_setCollectCyclesThreshold")
     private external fun setCollectCyclesThreshold(value: Long)
 
+    @SymbolName("Kotlin_native_internal_GC_getMaxPauseMicros")
+    private external fun getMaxPauseMicros(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_setMaxPauseMicros")
+    private external fun setMaxPauseMicros(value: Long)
+
     @SymbolName("Kotlin_native_internal_GC_getThresholdAllocations")
     private external fun getThresholdAllocations(): Long
 
@@ -124,9 +261,144 @@ object GC {
     @SymbolName("Kotlin_native_internal_GC_setTuneThreshold")
     private external fun setTuneThreshold(value: Boolean)
 
+    @SymbolName("Kotlin_native_internal_GC_getTargetOverhead")
+    private external fun getTargetOverhead(): Double
+
+    @SymbolName("Kotlin_native_internal_GC_setTargetOverhead")
+    private external fun setTargetOverhead(value: Double)
+
+    @SymbolName("Kotlin_native_internal_GC_getTargetHeapBytes")
+    private external fun getTargetHeapBytes(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_setTargetHeapBytes")
+    private external fun setTargetHeapBytes(value: Long)
+
+    @SymbolName("Kotlin_native_internal_GC_getSoftHeapLimit")
+    private external fun getSoftHeapLimit(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_setSoftHeapLimit")
+    private external fun setSoftHeapLimit(value: Long)
+
+    @SymbolName("Kotlin_native_internal_GC_getHardHeapLimit")
+    private external fun getHardHeapLimit(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_setHardHeapLimit")
+    private external fun setHardHeapLimit(value: Long)
+
+    @SymbolName("Kotlin_native_internal_GC_getAutoTrim")
+    private external fun getAutoTrim(): Boolean
+
+    @SymbolName("Kotlin_native_internal_GC_setAutoTrim")
+    private external fun setAutoTrim(value: Boolean)
+
+    @SymbolName("Kotlin_native_internal_GC_getHeapBytes")
+    private external fun getHeapBytes(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_getStatistics")
+    private external fun getStatistics(values: LongArray)
+
+    @SymbolName("Kotlin_native_internal_GC_getStablePointerRoots")
+    private external fun getStablePointerRoots(): Boolean
+
+    @SymbolName("Kotlin_native_internal_GC_setStablePointerRoots")
+    private external fun setStablePointerRoots(value: Boolean)
+
+    @SymbolName("Kotlin_native_internal_GC_getConcurrentMark")
+    private external fun getConcurrentMark(): Boolean
+
+    @SymbolName("Kotlin_native_internal_GC_setConcurrentMark")
+    private external fun setConcurrentMark(value: Boolean)
+
+    @SymbolName("Kotlin_native_internal_GC_getHelperThreads")
+    private external fun getHelperThreads(): Int
+
+    @SymbolName("Kotlin_native_internal_GC_setHelperThreads")
+    private external fun setHelperThreads(value: Int)
+
     @SymbolName("Kotlin_native_internal_GC_getCyclicCollector")
     private external fun getCyclicCollectorEnabled(): Boolean
 
     @SymbolName("Kotlin_native_internal_GC_setCyclicCollector")
     private external fun setCyclicCollectorEnabled(value: Boolean)
-}
\ No newline at end of file
+}
+
+@ThreadLocal
+private object HeapLimits {
+    var softHeapLimitHandler: ((Long) -> Unit)? = null
+}
+
+@ExportForCppRuntime("Kotlin_native_internal_GC_notifySoftHeapLimit")
+internal fun notifySoftHeapLimit(heapBytes: Long) {
+    HeapLimits.softHeapLimitHandler?.invoke(heapBytes)
+}
+
+/**
+ * Per-worker GC counters, accumulated since the worker start, see [GC.statistics].
+ */
+class GCStatistics internal constructor(private val values: LongArray) {
+    /** Number of garbage collections performed. */
+    val collections: Long get() = values[COLLECTIONS]
+
+    /** Number of garbage collections, which ran the cycle collector. */
+    val cycleCollections: Long get() = values[CYCLE_COLLECTIONS]
+
+    /** Total time spent in garbage collection pauses. */
+    val totalPauseMicros: Long get() = values[TOTAL_PAUSE_MICROS]
+
+    /** Longest garbage collection pause. */
+    val maxPauseMicros: Long get() = values[MAX_PAUSE_MICROS]
+
+    /** Bytes allocated for objects and arrays. */
+    val bytesAllocated: Long get() = values[BYTES_ALLOCATED]
+
+    /** Bytes of objects and arrays freed. Includes objects allocated by other workers, but freed by this one. */
+    val bytesFreed: Long get() = values[BYTES_FREED]
+
+    /** Number of cycle candidates awaiting the cycle collector. */
+    val toFreeSize: Long get() = values[TO_FREE_SIZE]
+
+    /** Number of delayed reference counter decrements awaiting the next collection. */
+    val toReleaseSize: Long get() = values[TO_RELEASE_SIZE]
+
+    /** Number of objects awaiting finalization. */
+    val finalizerQueueSize: Long get() = values[FINALIZER_QUEUE_SIZE]
+
+    /** Number of object subgraphs transferred to other workers without the full reachability check, as nobody else could refer to them. */
+    val freshTransfers: Long get() = values[FRESH_TRANSFERS]
+
+    /** Number of nursery chunks, where small objects are allocated, freed once all their objects died. */
+    val nurseryChunksFreed: Long get() = values[NURSERY_CHUNKS_FREED]
+
+    /** Bytes of nursery chunks kept alive by surviving objects, which were returned to the operating system. */
+    val nurseryBytesDiscarded: Long get() = values[NURSERY_BYTES_DISCARDED]
+
+    /**
+     * Number of pauses shorter than 100us, 1ms, 10ms, 100ms, and longer ones.
+     */
+    val pauseHistogram: LongArray get() = values.copyOfRange(PAUSE_HISTOGRAM, SIZE)
+
+    override fun toString() = "GCStatistics(collections=$collections, cycleCollections=$cycleCollections, " +
+            "totalPauseMicros=$totalPauseMicros, maxPauseMicros=$maxPauseMicros, " +
+            "bytesAllocated=$bytesAllocated, bytesFreed=$bytesFreed, toFreeSize=$toFreeSize, " +
+            "toReleaseSize=$toReleaseSize, finalizerQueueSize=$finalizerQueueSize, freshTransfers=$freshTransfers, " +
+            "nurseryChunksFreed=$nurseryChunksFreed, nurseryBytesDiscarded=$nurseryBytesDiscarded, " +
+            "pauseHistogram=${pauseHistogram.contentToString()})"
+
+    // Must match GcStatisticsIndex in Memory.cpp.
+    internal companion object {
+        const val COLLECTIONS = 0
+        const val CYCLE_COLLECTIONS = 1
+        const val TOTAL_PAUSE_MICROS = 2
+        const val MAX_PAUSE_MICROS = 3
+        const val BYTES_ALLOCATED = 4
+        const val BYTES_FREED = 5
+        const val TO_FREE_SIZE = 6
+        const val TO_RELEASE_SIZE = 7
+        const val FINALIZER_QUEUE_SIZE = 8
+        const val FRESH_TRANSFERS = 9
+        const val NURSERY_CHUNKS_FREED = 10
+        const val NURSERY_BYTES_DISCARDED = 11
+        const val PAUSE_HISTOGRAM = 12
+        const val SIZE = PAUSE_HISTOGRAM + 5
+    }
+}
@@ -209,7 +209,8 @@ actual class StringBuilder private constructor (
             var newSize = array.size * 2 + 2
             if (minimumCapacity > newSize)
                 newSize = minimumCapacity
-            array = array.copyOf(newSize)
+            if (!array.growInPlace(newSize))
+                array = array.copyOf(newSize)
         }
     }
 
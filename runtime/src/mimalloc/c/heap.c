@@ -165,6 +165,19 @@ void mi_collect(bool force) mi_attr_noexcept {
   mi_heap_collect(mi_get_default_heap(), force);
 }
 
+#if KONAN_MI_MALLOC
+// collect the heap and the default heap of this thread, and reset the memory no longer in use,
+// including free pages of the segments still in use, so that it is returned to the OS.
+void mi_heap_trim(mi_heap_t* heap) mi_attr_noexcept {
+  mi_heap_t* backing = mi_get_default_heap();
+  if (heap != NULL) mi_heap_collect(heap, true);
+  mi_heap_collect(backing, true);
+  if (!mi_heap_is_initialized(backing)) return;
+  _mi_segment_thread_reset_free(&backing->tld->segments);
+  _mi_mem_reset_free(&backing->tld->stats);
+}
+#endif
+
 
 /* -----------------------------------------------------------
   Heap new
@@ -517,6 +517,35 @@ void _mi_mem_collect(mi_stats_t* stats) {
   }
 }
 
+#if KONAN_MI_MALLOC
+// reset the memory of all blocks which are not in use, so that it is returned to the OS.
+// blocks are claimed while being reset, so they cannot be allocated concurrently.
+void _mi_mem_reset_free(mi_stats_t* stats) {
+  // decommitted blocks would need to be committed again on allocation
+  if (mi_option_is_enabled(mi_option_reset_decommits)) return;
+  size_t count = mi_atomic_read_relaxed(&regions_count);
+  for (size_t i = 0; i < count; i++) {
+    mem_region_t* region = &regions[i];
+    bool is_large;
+    void* start = mi_region_info_read(mi_atomic_read(&region->info), &is_large, NULL);
+    if (start == NULL || is_large || _mi_os_is_huge_reserved(start)) continue;
+    for (size_t bitidx = 0; bitidx < MI_REGION_MAP_BITS; bitidx++) {
+      uintptr_t mask = mi_region_block_mask(1, bitidx);
+      uintptr_t map = mi_atomic_read_relaxed(&region->map);
+      // only blocks which were used before can be resident
+      if ((map & mask) != 0 || (mi_atomic_read_relaxed(&region->dirty_mask) & mask) == 0) continue;
+      if (!mi_atomic_cas_strong(&region->map, map | mask, map)) continue;
+      _mi_os_reset((uint8_t*)start + (bitidx * MI_SEGMENT_SIZE), MI_SEGMENT_SIZE, stats);
+      uintptr_t newmap;
+      do {
+        map = mi_atomic_read_relaxed(&region->map);
+        newmap = map & ~mask;
+      } while (!mi_atomic_cas_weak(&region->map, newmap, map));
+    }
+  }
+}
+#endif
+
 /* ----------------------------------------------------------------------------
   Other
 -----------------------------------------------------------------------------*/
@@ -298,6 +298,29 @@ void _mi_segment_thread_collect(mi_segments_tld_t* tld) {
   mi_assert_internal(tld->cache == NULL);
 }
 
+#if KONAN_MI_MALLOC
+static void mi_segment_queue_reset_free(mi_segment_queue_t* queue, mi_stats_t* stats) {
+  for (mi_segment_t* segment = queue->first; segment != NULL; segment = segment->next) {
+    if (segment->mem_is_fixed) continue;
+    for (size_t i = 0; i < segment->capacity; i++) {
+      mi_page_t* page = &segment->pages[i];
+      if (page->segment_in_use || page->is_reset || !page->is_committed) continue;
+      size_t psize;
+      uint8_t* start = _mi_page_start(segment, page, &psize);
+      page->is_reset = true;
+      _mi_mem_reset(start, psize, stats);
+    }
+  }
+}
+
+// reset the memory of the free pages in the segments of this thread, so that it is returned to the OS.
+// the pages are unreset when they are used again, see `mi_segment_find_free`.
+void _mi_segment_thread_reset_free(mi_segments_tld_t* tld) {
+  mi_segment_queue_reset_free(&tld->small_free, tld->stats);
+  mi_segment_queue_reset_free(&tld->medium_free, tld->stats);
+}
+#endif
+
 
 /* -----------------------------------------------------------
    Segment allocation
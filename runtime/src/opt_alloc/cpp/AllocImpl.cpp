@@ -9,6 +9,12 @@ extern "C" {
 void* mi_calloc(size_t, size_t);
 void mi_free(void*);
 void* mi_calloc_aligned(size_t count, size_t size, size_t alignment);
+struct mi_heap_s;
+mi_heap_s* mi_heap_new();
+void mi_heap_delete(mi_heap_s* heap);
+void* mi_heap_calloc(mi_heap_s* heap, size_t count, size_t size);
+void* mi_heap_calloc_aligned(mi_heap_s* heap, size_t count, size_t size, size_t alignment);
+void mi_heap_trim(mi_heap_s* heap);
 
 void* konan_calloc_impl(size_t n_elements, size_t elem_size) {
  return mi_calloc(n_elements, elem_size);
@@ -21,4 +27,26 @@ void* konan_calloc_aligned_impl(size_t count, size_t size, size_t alignment) {
 void konan_free_impl (void* mem) {
   mi_free(mem);
 }
+
+void* konan_heap_create_impl() {
+  return mi_heap_new();
+}
+
+void konan_heap_destroy_impl(void* heap) {
+  // Blocks still in use are moved to the default heap of the thread, and can be freed later as usual.
+  mi_heap_delete(reinterpret_cast<mi_heap_s*>(heap));
+}
+
+void* konan_heap_calloc_impl(void* heap, size_t n_elements, size_t elem_size) {
+  return mi_heap_calloc(reinterpret_cast<mi_heap_s*>(heap), n_elements, elem_size);
+}
+
+void* konan_heap_calloc_aligned_impl(void* heap, size_t count, size_t size, size_t alignment) {
+  return mi_heap_calloc_aligned(reinterpret_cast<mi_heap_s*>(heap), count, size, alignment);
+}
+
+void konan_heap_trim_impl(void* heap) {
+  // Also resets free pages of the segments in use, which mi_heap_collect() keeps resident.
+  mi_heap_trim(reinterpret_cast<mi_heap_s*>(heap));
+}
 }  // extern "C"
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+/**
+ * Allocator tuned for the containers of Kotlin objects, which are small, 8-byte aligned and zero initialized.
+ * Small blocks are carved out of pages dedicated to a single size class, so blocks have no header: size of a block
+ * is found by the page it belongs to. Pages are taken from arenas mapped directly from the OS, so fresh blocks are
+ * already zero, and only reused blocks are cleared on allocation.
+ * Every thread keeps a few free blocks of each size class, exchanging them with the global lists in batches.
+ * Larger blocks are served by the system allocator.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "Porting.h"
+
+namespace {
+
+// Arenas are aligned to their size, so that arena of the block is found by masking its address.
+constexpr uintptr_t kArenaSize = 4 * 1024 * 1024;
+constexpr uintptr_t kPageSize = 64 * 1024;
+constexpr int kPagesPerArena = kArenaSize / kPageSize;
+// Blocks up to this size are allocated in slabs, with a size class for every 8 bytes.
+constexpr size_t kBlockAlignment = 8;
+constexpr size_t kMaxSmallSize = 256;
+constexpr int kSizeClasses = kMaxSmallSize / kBlockAlignment + 1;
+// Capacity of the table of all the arenas, limits slab memory to kMaxArenas * kArenaSize.
+constexpr int kMaxArenas = 4096;
+// How many blocks are moved between the thread cache and the global list at once.
+constexpr int kTransferBatch = 32;
+// Thread cache of a size class returns kTransferBatch blocks to the global list when it has more than that.
+constexpr int kMaxCachedBlocks = 2 * kTransferBatch;
+// How many times a busy lock is polled with a pause, before yielding the thread instead.
+constexpr int kLockSpins = 64;
+
+struct Block {
+  Block* next;
+};
+
+struct Arena {
+  // Size class of each page, 0 if the page is not in use. Page 0 holds the arena itself.
+  uint8_t pageClass[kPagesPerArena];
+};
+
+class SpinLock {
+ public:
+  void lock() {
+    int spins = 0;
+    while (__atomic_test_and_set(&locked_, __ATOMIC_ACQUIRE)) {
+      // Wait on plain loads, so that the cache line is not bounced between the waiting threads.
+      while (__atomic_load_n(&locked_, __ATOMIC_RELAXED)) {
+        if (spins++ < kLockSpins)
+          konan::spinPause();
+        else
+          konan::yieldThread();
+      }
+    }
+  }
+
+  void unlock() {
+    __atomic_clear(&locked_, __ATOMIC_RELEASE);
+  }
+
+ private:
+  bool locked_ = false;
+};
+
+struct SizeClass {
+  SpinLock lock;
+  // Freed blocks, not zeroed.
+  Block* free;
+  // Untouched part of the page currently carved, still zero.
+  uint8_t* top;
+  uint8_t* end;
+};
+
+struct ThreadCache {
+  // Freed blocks, not zeroed.
+  Block* blocks[kSizeClasses];
+  int count[kSizeClasses];
+  // Untouched blocks taken from the page, still zero.
+  uint8_t* freshTop[kSizeClasses];
+  uint8_t* freshEnd[kSizeClasses];
+};
+
+SizeClass sizeClasses[kSizeClasses];
+
+SpinLock arenaLock;
+Arena* currentArena = nullptr;
+int nextPage = kPagesPerArena;
+int arenaCount = 0;
+// Open addressing hash table of all the arenas, entries are never removed, so lookup needs no lock.
+Arena* arenaTable[kMaxArenas];
+
+pthread_key_t threadCacheKey;
+pthread_once_t threadCacheKeyOnce = PTHREAD_ONCE_INIT;
+__thread ThreadCache* threadCache = nullptr;
+
+inline int sizeClassOf(size_t size) {
+  return size == 0 ? 1 : static_cast<int>((size + kBlockAlignment - 1) / kBlockAlignment);
+}
+
+inline size_t blockSize(int sizeClass) {
+  return sizeClass * kBlockAlignment;
+}
+
+inline size_t arenaHash(uintptr_t arena) {
+  return (arena / kArenaSize) % kMaxArenas;
+}
+
+Arena* findArena(const void* pointer) {
+  uintptr_t arena = reinterpret_cast<uintptr_t>(pointer) & ~(kArenaSize - 1);
+  for (size_t index = arenaHash(arena), probe = 0; probe < kMaxArenas; index = (index + 1) % kMaxArenas, probe++) {
+    Arena* entry = __atomic_load_n(&arenaTable[index], __ATOMIC_ACQUIRE);
+    if (entry == nullptr) return nullptr;
+    if (reinterpret_cast<uintptr_t>(entry) == arena) return entry;
+  }
+  return nullptr;
+}
+
+// Must be called under arenaLock.
+Arena* mapArena() {
+  // Keep the table sparse, so that lookup of the foreign blocks stays short.
+  if (arenaCount >= kMaxArenas * 3 / 4) return nullptr;
+  void* mapped = mmap(nullptr, 2 * kArenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (mapped == MAP_FAILED) return nullptr;
+  uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+  uintptr_t aligned = (start + kArenaSize - 1) & ~(kArenaSize - 1);
+  if (aligned > start)
+    munmap(mapped, aligned - start);
+  if (start + 2 * kArenaSize > aligned + kArenaSize)
+    munmap(reinterpret_cast<void*>(aligned + kArenaSize), start + 2 * kArenaSize - aligned - kArenaSize);
+  auto* arena = reinterpret_cast<Arena*>(aligned);
+  size_t index = arenaHash(aligned);
+  while (arenaTable[index] != nullptr)
+    index = (index + 1) % kMaxArenas;
+  __atomic_store_n(&arenaTable[index], arena, __ATOMIC_RELEASE);
+  arenaCount++;
+  return arena;
+}
+
+// Returns zeroed page for the given size class, or nullptr if slab memory is exhausted.
+uint8_t* allocPage(int sizeClass) {
+  arenaLock.lock();
+  if (nextPage == kPagesPerArena) {
+    Arena* arena = mapArena();
+    if (arena == nullptr) {
+      arenaLock.unlock();
+      return nullptr;
+    }
+    currentArena = arena;
+    nextPage = 1;
+  }
+  int page = nextPage++;
+  currentArena->pageClass[page] = static_cast<uint8_t>(sizeClass);
+  auto* result = reinterpret_cast<uint8_t*>(currentArena) + page * kPageSize;
+  arenaLock.unlock();
+  return result;
+}
+
+void flushThreadCache(void* argument) {
+  auto* cache = reinterpret_cast<ThreadCache*>(argument);
+  for (int sizeClass = 1; sizeClass < kSizeClasses; sizeClass++) {
+    size_t size = blockSize(sizeClass);
+    for (uint8_t* fresh = cache->freshTop[sizeClass]; fresh != cache->freshEnd[sizeClass]; fresh += size) {
+      auto* block = reinterpret_cast<Block*>(fresh);
+      block->next = cache->blocks[sizeClass];
+      cache->blocks[sizeClass] = block;
+    }
+    auto& global = sizeClasses[sizeClass];
+    global.lock.lock();
+    while (cache->blocks[sizeClass] != nullptr) {
+      Block* block = cache->blocks[sizeClass];
+      cache->blocks[sizeClass] = block->next;
+      block->next = global.free;
+      global.free = block;
+    }
+    global.lock.unlock();
+  }
+  threadCache = nullptr;
+  free(cache);
+}
+
+void createThreadCacheKey() {
+  pthread_key_create(&threadCacheKey, flushThreadCache);
+}
+
+ThreadCache* getThreadCache() {
+  ThreadCache* cache = threadCache;
+  if (cache != nullptr) return cache;
+  cache = reinterpret_cast<ThreadCache*>(calloc(1, sizeof(ThreadCache)));
+  if (cache == nullptr) return nullptr;
+  pthread_once(&threadCacheKeyOnce, createThreadCacheKey);
+  // Blocks cached by the thread are returned to the global lists when it exits.
+  pthread_setspecific(threadCacheKey, cache);
+  threadCache = cache;
+  return cache;
+}
+
+// Takes up to kTransferBatch freed blocks from the global list, or as many fresh blocks, when the thread cache is empty.
+void refill(ThreadCache* cache, int sizeClass) {
+  auto& global = sizeClasses[sizeClass];
+  size_t size = blockSize(sizeClass);
+  Block* blocks = nullptr;
+  int count = 0;
+  global.lock.lock();
+  while (count < kTransferBatch && global.free != nullptr) {
+    Block* block = global.free;
+    global.free = block->next;
+    block->next = blocks;
+    blocks = block;
+    count++;
+  }
+  if (count == 0) {
+    if (global.top == global.end) {
+      global.top = allocPage(sizeClass);
+      global.end = global.top == nullptr ? nullptr : global.top + kPageSize / size * size;
+    }
+    size_t available = global.end - global.top;
+    size_t batch = available < kTransferBatch * size ? available : kTransferBatch * size;
+    cache->freshTop[sizeClass] = global.top;
+    cache->freshEnd[sizeClass] = global.top + batch;
+    global.top += batch;
+  }
+  global.lock.unlock();
+  cache->blocks[sizeClass] = blocks;
+  cache->count[sizeClass] = count;
+}
+
+void* allocSmall(size_t size) {
+  ThreadCache* cache = getThreadCache();
+  if (cache == nullptr) return nullptr;
+  int sizeClass = sizeClassOf(size);
+  if (cache->blocks[sizeClass] == nullptr && cache->freshTop[sizeClass] == cache->freshEnd[sizeClass]) {
+    refill(cache, sizeClass);
+  }
+  Block* result = cache->blocks[sizeClass];
+  if (result != nullptr) {
+    cache->blocks[sizeClass] = result->next;
+    cache->count[sizeClass]--;
+    memset(result, 0, blockSize(sizeClass));
+    return result;
+  }
+  if (cache->freshTop[sizeClass] == cache->freshEnd[sizeClass]) return nullptr;
+  void* fresh = cache->freshTop[sizeClass];
+  cache->freshTop[sizeClass] += blockSize(sizeClass);
+  return fresh;
+}
+
+void freeSmall(Arena* arena, void* pointer) {
+  int page = (reinterpret_cast<uintptr_t>(pointer) - reinterpret_cast<uintptr_t>(arena)) / kPageSize;
+  int sizeClass = arena->pageClass[page];
+  auto* block = reinterpret_cast<Block*>(pointer);
+  auto& global = sizeClasses[sizeClass];
+  ThreadCache* cache = getThreadCache();
+  if (cache == nullptr) {
+    global.lock.lock();
+    block->next = global.free;
+    global.free = block;
+    global.lock.unlock();
+    return;
+  }
+  block->next = cache->blocks[sizeClass];
+  cache->blocks[sizeClass] = block;
+  if (++cache->count[sizeClass] <= kMaxCachedBlocks) return;
+  Block* first = cache->blocks[sizeClass];
+  Block* last = first;
+  for (int i = 1; i < kTransferBatch; i++)
+    last = last->next;
+  cache->blocks[sizeClass] = last->next;
+  cache->count[sizeClass] -= kTransferBatch;
+  global.lock.lock();
+  last->next = global.free;
+  global.free = first;
+  global.lock.unlock();
+}
+
+}  // namespace
+
+extern "C" {
+// Memory operations.
+void* konan_calloc_impl(size_t n_elements, size_t elem_size) {
+  size_t size = n_elements * elem_size;
+  if (elem_size != 0 && size / elem_size != n_elements) return nullptr;
+  if (size <= kMaxSmallSize) {
+    void* result = allocSmall(size);
+    if (result != nullptr) return result;
+  }
+  return calloc(n_elements, elem_size);
+}
+
+void* konan_calloc_aligned_impl(size_t count, size_t size, size_t alignment) {
+  if (alignment <= kBlockAlignment)
+    return konan_calloc_impl(count, size);
+  if (alignment <= sizeof(void*) * 2)
+    return calloc(count, size);
+  size_t total = count * size;
+  if (size != 0 && total / size != count) return nullptr;
+  void* result = nullptr;
+  if (posix_memalign(&result, alignment, total) != 0) return nullptr;
+  memset(result, 0, total);
+  return result;
+}
+
+void konan_free_impl (void* mem) {
+  if (mem == nullptr) return;
+  Arena* arena = findArena(mem);
+  if (arena != nullptr)
+    freeSmall(arena, mem);
+  else
+    free(mem);
+}
+
+// Slabs are shared by all threads, with per-thread caches, so there are no separate heaps.
+void* konan_heap_create_impl() {
+  return nullptr;
+}
+
+void konan_heap_destroy_impl(void* heap) {}
+
+void* konan_heap_calloc_impl(void* heap, size_t n_elements, size_t elem_size) {
+  return konan_calloc_impl(n_elements, elem_size);
+}
+
+void* konan_heap_calloc_aligned_impl(void* heap, size_t count, size_t size, size_t alignment) {
+  return konan_calloc_aligned_impl(count, size, alignment);
+}
+
+// Slab pages are not returned, as free blocks are not counted per page, only the system allocator is trimmed.
+void konan_heap_trim_impl(void* heap) {
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
+}  // extern "C"
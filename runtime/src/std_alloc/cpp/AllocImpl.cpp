@@ -4,6 +4,10 @@
  */
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 extern "C" {
 // Memory operations.
@@ -12,12 +16,44 @@ void* konan_calloc_impl(size_t n_elements, size_t elem_size) {
 }
 
 void* konan_calloc_aligned_impl(size_t count, size_t size, size_t alignment) {
-  // alignment is not supported by std alloc - use mimalloc
+#if KONAN_WINDOWS
+  // Aligned memory on Windows cannot be released with free() - use mimalloc.
   return calloc(count, size);
+#else
+  if (alignment <= sizeof(void*) * 2)
+    return calloc(count, size);
+  size_t total = count * size;
+  if (size != 0 && total / size != count) return nullptr;
+  void* result = nullptr;
+  if (posix_memalign(&result, alignment, total) != 0) return nullptr;
+  memset(result, 0, total);
+  return result;
+#endif
 }
 
 void konan_free_impl (void* mem) {
   free(mem);
 }
+
+// Separate heaps are not supported by std alloc, everything is allocated in the global one.
+void* konan_heap_create_impl() {
+  return nullptr;
+}
+
+void konan_heap_destroy_impl(void* heap) {}
+
+void* konan_heap_calloc_impl(void* heap, size_t n_elements, size_t elem_size) {
+  return calloc(n_elements, elem_size);
+}
+
+void* konan_heap_calloc_aligned_impl(void* heap, size_t count, size_t size, size_t alignment) {
+  return konan_calloc_aligned_impl(count, size, alignment);
+}
+
+void konan_heap_trim_impl(void* heap) {
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
 }
 
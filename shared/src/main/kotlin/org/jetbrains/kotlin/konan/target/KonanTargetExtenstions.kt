@@ -20,4 +20,11 @@ fun KonanTarget.supportsMimallocAllocator(): Boolean =
         is KonanTarget.IOS_ARM64 -> true
         is KonanTarget.IOS_X64 -> true
         else -> false // watchOS/tvOS/android_x86/android_arm32 aren't tested; linux_mips32/linux_mipsel32 need linking with libatomic.
-    }
\ No newline at end of file
+    }
+
+// Slab allocator maps its memory directly and relies on pthreads.
+fun KonanTarget.supportsSlabAllocator(): Boolean =
+    when (family) {
+        Family.LINUX, Family.ANDROID, Family.OSX, Family.IOS, Family.TVOS, Family.WATCHOS -> true
+        else -> false
+    }
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+#
+# Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+# that can be found in the LICENSE file.
+#
+# Converts a heap snapshot written by kotlin.native.internal.GC.dumpHeap() to a dominator tree report.
+# Retained size of an object is the total size of the objects which would be freed together with it,
+# i.e. the objects it dominates in the object graph rooted at all the heap roots.
+#
+# Usage: heapReport.py [--top N] [--depth N] [--min-percent P] heap.bin
+
+import argparse
+import struct
+import sys
+from collections import defaultdict
+
+ROOT_KINDS = {1: "stack", 2: "global", 3: "thread local", 4: "stable pointer"}
+
+
+class Heap:
+    def __init__(self):
+        self.type_names = {}
+        # Objects are numbered in the order of appearance, 0 is the virtual root.
+        self.index = {0: 0}
+        self.addresses = [0]
+        self.types = [None]
+        self.sizes = [0]
+        self.edges = [[]]
+        self.root_kinds = {}
+
+    def node(self, address):
+        result = self.index.get(address)
+        if result is None:
+            result = len(self.addresses)
+            self.index[address] = result
+            self.addresses.append(address)
+            self.types.append(None)
+            self.sizes.append(0)
+            self.edges.append([])
+        return result
+
+    def type_name(self, node):
+        if node == 0:
+            return "<roots>"
+        return self.type_names.get(self.types[node], "<unknown>")
+
+
+def read_heap(path):
+    with open(path, "rb") as file:
+        data = file.read()
+    if data[:8] != b"KNHEAP01":
+        raise ValueError("%s is not a Kotlin/Native heap dump" % path)
+    heap = Heap()
+    offset = 8
+    while offset < len(data):
+        tag = data[offset:offset + 1]
+        offset += 1
+        if tag == b"T":
+            type_id, length = struct.unpack_from("<II", data, offset)
+            offset += 8
+            heap.type_names[type_id] = data[offset:offset + length].decode("utf-8", "replace")
+            offset += length
+        elif tag == b"R":
+            kind, address = struct.unpack_from("<BQ", data, offset)
+            offset += 9
+            node = heap.node(address)
+            heap.edges[0].append(node)
+            heap.root_kinds.setdefault(node, ROOT_KINDS.get(kind, "unknown"))
+        elif tag == b"O":
+            address, type_id, size, count = struct.unpack_from("<QIII", data, offset)
+            offset += 20
+            node = heap.node(address)
+            heap.types[node] = type_id
+            heap.sizes[node] = size
+            heap.edges[node] = [heap.node(ref) for ref in struct.unpack_from("<%dQ" % count, data, offset)]
+            offset += 8 * count
+        elif tag == b"E":
+            return heap
+        else:
+            raise ValueError("Corrupted heap dump at offset %d" % (offset - 1))
+    raise ValueError("Truncated heap dump %s" % path)
+
+
+def reverse_postorder(heap):
+    visited = [False] * len(heap.addresses)
+    order = []
+    visited[0] = True
+    stack = [(0, iter(heap.edges[0]))]
+    while stack:
+        node, children = stack[-1]
+        for child in children:
+            if not visited[child]:
+                visited[child] = True
+                stack.append((child, iter(heap.edges[child])))
+                break
+        else:
+            stack.pop()
+            order.append(node)
+    order.reverse()
+    return order
+
+
+def dominators(heap):
+    """Iterative algorithm by Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm"."""
+    order = reverse_postorder(heap)
+    position = [-1] * len(heap.addresses)
+    for index, node in enumerate(order):
+        position[node] = index
+    predecessors = defaultdict(list)
+    for node in order:
+        for child in heap.edges[node]:
+            predecessors[child].append(node)
+
+    idom = [-1] * len(heap.addresses)
+    idom[0] = 0
+
+    def intersect(first, second):
+        while first != second:
+            while position[first] > position[second]:
+                first = idom[first]
+            while position[second] > position[first]:
+                second = idom[second]
+        return first
+
+    changed = True
+    while changed:
+        changed = False
+        for node in order[1:]:
+            new_idom = -1
+            for predecessor in predecessors[node]:
+                if idom[predecessor] == -1:
+                    continue
+                new_idom = predecessor if new_idom == -1 else intersect(predecessor, new_idom)
+            if idom[node] != new_idom:
+                idom[node] = new_idom
+                changed = True
+    return order, idom
+
+
+def retained_sizes(heap, order, idom):
+    retained = list(heap.sizes)
+    for node in reversed(order[1:]):
+        retained[idom[node]] += retained[node]
+    return retained
+
+
+def describe(heap, node, retained):
+    root = heap.root_kinds.get(node)
+    return "%s@%x shallow=%d retained=%d%s" % (
+        heap.type_name(node), heap.addresses[node], heap.sizes[node], retained[node],
+        " (%s root)" % root if root else "")
+
+
+def print_report(heap, top, depth, min_percent, out):
+    order, idom = dominators(heap)
+    retained = retained_sizes(heap, order, idom)
+    total = retained[0]
+    out.write("Objects: %d, total size: %d bytes, roots: %d\n\n" % (len(order) - 1, total, len(heap.root_kinds)))
+
+    children = defaultdict(list)
+    for node in order[1:]:
+        children[idom[node]].append(node)
+    threshold = total * min_percent / 100.0
+
+    out.write("Dominator tree (objects retaining at least %.1f%% of the heap):\n" % min_percent)
+    stack = [(0, 0)]
+    while stack:
+        node, level = stack.pop()
+        out.write("%s%s\n" % ("  " * level, describe(heap, node, retained)))
+        if level < depth:
+            subtree = sorted(children[node], key=lambda child: retained[child], reverse=True)
+            subtree = [child for child in subtree[:top] if retained[child] >= threshold]
+            for child in reversed(subtree):
+                stack.append((child, level + 1))
+
+    by_type = defaultdict(lambda: [0, 0, 0])
+    for node in order[1:]:
+        stats = by_type[heap.type_name(node)]
+        stats[0] += 1
+        stats[1] += heap.sizes[node]
+        # Only count retained size of the topmost objects of the type, so that nested ones are not counted twice.
+        parent = idom[node]
+        while parent != 0 and heap.types[parent] != heap.types[node]:
+            parent = idom[parent]
+        if parent == 0:
+            stats[2] += retained[node]
+    out.write("\nTypes by retained size:\n")
+    out.write("%10s %14s %14s  %s\n" % ("count", "shallow", "retained", "type"))
+    for name, stats in sorted(by_type.items(), key=lambda item: item[1][2], reverse=True)[:top]:
+        out.write("%10d %14d %14d  %s\n" % (stats[0], stats[1], stats[2], name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Dominator tree report for a Kotlin/Native heap dump.")
+    parser.add_argument("dump", help="file written by GC.dumpHeap()")
+    parser.add_argument("--top", type=int, default=20, help="number of children and types to show")
+    parser.add_argument("--depth", type=int, default=8, help="depth of the dominator tree to show")
+    parser.add_argument("--min-percent", type=float, default=1.0,
+                        help="hide subtrees retaining less than this percent of the heap")
+    args = parser.parse_args()
+    print_report(read_heap(args.dump), args.top, args.depth, args.min_percent, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()